@@ -0,0 +1,267 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file bench.cpp
+ * @brief Benchmark driver for the ready queue implementations. It runs a configurable mix of inserts and
+ * removes and prints the throughput and per-operation latency percentiles of each queue as JSON.
+ *
+ * Usage: ./bench [--size N] [--insert-ratio R] [--dist uniform|zipf|bimodal] [--ops N] [--queue NAME] [--seed N]
+ *   --size          number of PCBs in the workload; about half of them start in the queue (default 500)
+ *   --insert-ratio  fraction of operations that are inserts, between 0 and 1 (default 0.5)
+ *   --dist          distribution of the priorities given to inserted PCBs (default uniform)
+ *   --ops           number of operations (default 1000000)
+ *   --queue         readyqueue, sharded, concurrent or all (default all)
+ *   --seed          random seed (default 1)
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "readyqueue.h"
+#include "shardedreadyqueue.h"
+#include "concurrentreadyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+// Number of priority levels used by the workload, as in test2
+static const int NUM_PRIORITIES = 50;
+
+// The parameters of one benchmark run
+struct Config {
+    int size;
+    double insertRatio;
+    string dist;
+    long ops;
+    string queue;
+    unsigned int seed;
+};
+
+/**
+ * @brief Draws priorities in 1..NUM_PRIORITIES from the configured distribution.
+ * - uniform: every level is equally likely
+ * - zipf: level k (counting from the highest) has weight 1/k, so a few high priorities dominate
+ * - bimodal: half of the PCBs are around priority 10 and half around 40
+ */
+class PriorityGenerator {
+private:
+    mt19937 rng;
+    discrete_distribution<int> levels;
+
+public:
+    PriorityGenerator(const string &dist, unsigned int seed) : rng(seed) {
+        vector<double> weights(NUM_PRIORITIES);
+        for (int k = 0; k < NUM_PRIORITIES; k++) {
+            int priority = k + 1;
+            if (dist == "zipf") {
+                weights[k] = 1.0 / (NUM_PRIORITIES - k);
+            } else if (dist == "bimodal") {
+                weights[k] = exp(-0.5 * pow((priority - 10) / 3.0, 2)) + exp(-0.5 * pow((priority - 40) / 3.0, 2));
+            } else {
+                weights[k] = 1.0;
+            }
+        }
+        levels = discrete_distribution<int>(weights.begin(), weights.end());
+    }
+
+    unsigned int next() {
+        return levels(rng) + 1;
+    }
+};
+
+// Adapters that give every queue the same add/remove interface. A single-threaded benchmark uses
+// shard 0 of the sharded queue.
+struct ReadyQueueAdapter {
+    ReadyQueue queue;
+    ReadyQueueAdapter(int size) {}
+    void add(PCB *pcb) { queue.addPCB(pcb); }
+    PCB *remove() { return queue.removePCB(); }
+};
+
+struct ShardedAdapter {
+    ShardedReadyQueue queue;
+    ShardedAdapter(int size) : queue(1) {}
+    void add(PCB *pcb) { queue.addPCB(pcb, 0); }
+    PCB *remove() { return queue.removePCB(0); }
+};
+
+struct ConcurrentAdapter {
+    ConcurrentReadyQueue queue;
+    // Every PCB could end up at the same priority level
+    ConcurrentAdapter(int size) : queue(size) {}
+    void add(PCB *pcb) { queue.addPCB(pcb); }
+    PCB *remove() { return queue.removePCB(); }
+};
+
+/**
+ * @brief Get a percentile of a set of latencies.
+ *
+ * @param samples: the latencies in nanoseconds; reordered by the call
+ * @param fraction: the percentile as a fraction, e.g. 0.99
+ * @return uint32_t: the latency at that percentile, or 0 if there are no samples
+ */
+uint32_t percentile(vector<uint32_t> &samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t k = (size_t) (fraction * (samples.size() - 1));
+    nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+/**
+ * @brief Print the latency summary of one operation type as a JSON object.
+ */
+void print_latency(const char *name, vector<uint32_t> &samples) {
+    cout << "      \"" << name << "\": {\"count\": " << samples.size()
+         << ", \"p50_ns\": " << percentile(samples, 0.50)
+         << ", \"p99_ns\": " << percentile(samples, 0.99)
+         << ", \"p999_ns\": " << percentile(samples, 0.999)
+         << ", \"max_ns\": " << (samples.empty() ? 0 : *max_element(samples.begin(), samples.end())) << "}";
+}
+
+/**
+ * @brief Run the workload against one queue and print its results as a JSON object.
+ * An insert takes a random PCB that is not queued and gives it a priority from the distribution; a remove
+ * dispatches the highest priority PCB. When the chosen operation is impossible (nothing to insert or an
+ * empty queue) the other one is done instead, so every operation does work.
+ *
+ * @param name: the name of the queue
+ * @param config: the workload parameters
+ * @param last: whether this is the last result, which ends the JSON array
+ */
+template <typename Adapter>
+void run_bench(const char *name, const Config &config, bool last) {
+    Adapter queue(config.size);
+    PCBTable table(config.size);
+    PriorityGenerator priorities(config.dist, config.seed);
+    mt19937 rng(config.seed);
+    uniform_real_distribution<double> coin(0.0, 1.0);
+
+    // PCBs that are not in the queue, available for inserts
+    vector<PCB *> idle;
+    int queued = 0;
+    for (int i = 0; i < config.size; i++) {
+        table.addNewPCB(i + 1, priorities.next(), i);
+        if (rng() % 2 == 0) {
+            queue.add(table.getPCB(i));
+            queued++;
+        } else {
+            idle.push_back(table.getPCB(i));
+        }
+    }
+
+    vector<uint32_t> inserts, removes;
+    inserts.reserve((size_t) (config.ops * config.insertRatio) + 1);
+    removes.reserve((size_t) (config.ops * (1 - config.insertRatio)) + 1);
+    int maxDepth = queued;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < config.ops; i++) {
+        bool insert = coin(rng) < config.insertRatio;
+        if (insert ? idle.empty() : queued == 0) {
+            insert = !insert;
+        }
+        if (insert) {
+            size_t idx = rng() % idle.size();
+            PCB *pcb = idle[idx];
+            idle[idx] = idle.back();
+            idle.pop_back();
+            pcb->setPriority(priorities.next());
+            auto t1 = std::chrono::steady_clock::now();
+            queue.add(pcb);
+            auto t2 = std::chrono::steady_clock::now();
+            inserts.push_back((uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+            queued++;
+            maxDepth = max(maxDepth, queued);
+        } else {
+            auto t1 = std::chrono::steady_clock::now();
+            PCB *pcb = queue.remove();
+            auto t2 = std::chrono::steady_clock::now();
+            removes.push_back((uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+            idle.push_back(pcb);
+            queued--;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    // The total includes the workload's own bookkeeping and the clock reads around each operation
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    cout << "    {" << endl;
+    cout << "      \"queue\": \"" << name << "\"," << endl;
+    cout << "      \"seconds\": " << seconds << "," << endl;
+    cout << "      \"ops_per_second\": " << config.ops / seconds << "," << endl;
+    cout << "      \"max_depth\": " << maxDepth << "," << endl;
+    print_latency("insert", inserts);
+    cout << "," << endl;
+    print_latency("remove", removes);
+    cout << endl << "    }" << (last ? "" : ",") << endl;
+}
+
+/**
+ * @brief Print the usage message.
+ */
+void usage(const char *prog) {
+    cerr << "Usage: " << prog << " [--size N] [--insert-ratio R] [--dist uniform|zipf|bimodal] [--ops N]"
+         << " [--queue readyqueue|sharded|concurrent|all] [--seed N]" << endl;
+}
+
+int main(int argc, char *argv[]) {
+    Config config = {500, 0.5, "uniform", 1000000, "all", 1};
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        string opt = argv[i];
+        const char *value = argv[++i];
+        if (opt == "--size") {
+            config.size = atoi(value);
+        } else if (opt == "--insert-ratio") {
+            config.insertRatio = atof(value);
+        } else if (opt == "--dist") {
+            config.dist = value;
+        } else if (opt == "--ops") {
+            config.ops = atol(value);
+        } else if (opt == "--queue") {
+            config.queue = value;
+        } else if (opt == "--seed") {
+            config.seed = (unsigned int) atoi(value);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    bool validDist = config.dist == "uniform" || config.dist == "zipf" || config.dist == "bimodal";
+    bool validQueue = config.queue == "readyqueue" || config.queue == "sharded" || config.queue == "concurrent" ||
+                      config.queue == "all";
+    if (config.size < 1 || config.ops < 0 || config.insertRatio < 0 || config.insertRatio > 1 || !validDist ||
+        !validQueue) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    cout << "{" << endl;
+    cout << "  \"config\": {\"size\": " << config.size << ", \"insert_ratio\": " << config.insertRatio
+         << ", \"dist\": \"" << config.dist << "\", \"ops\": " << config.ops << ", \"seed\": " << config.seed
+         << "}," << endl;
+    cout << "  \"results\": [" << endl;
+    bool all = config.queue == "all";
+    if (all || config.queue == "readyqueue") {
+        run_bench<ReadyQueueAdapter>("readyqueue", config, !all);
+    }
+    if (all || config.queue == "sharded") {
+        run_bench<ShardedAdapter>("sharded", config, !all);
+    }
+    if (all || config.queue == "concurrent") {
+        run_bench<ConcurrentAdapter>("concurrent", config, true);
+    }
+    cout << "  ]" << endl;
+    cout << "}" << endl;
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file concurrentreadyqueue.cpp
+ * @brief This is the implementation file for the ConcurrentReadyQueue class.
+ */
+#include <iostream>
+#include "concurrentreadyqueue.h"
+
+using namespace std;
+
+/**
+ * @brief Index of the highest set bit of a non-zero bitmap.
+ *
+ * @param bits: a bitmap with at least one bit set
+ * @return int: the index of the most significant set bit
+ */
+static inline int highest_bit(uint64_t bits) {
+    return 63 - __builtin_clzll(bits);
+}
+
+/**
+ * @brief Construct a new ConcurrentReadyQueue object
+ *
+ * @param capacityPerLevel: the maximum number of PCBs queued at one priority level. It is rounded up to
+ * a power of two.
+ */
+ConcurrentReadyQueue::ConcurrentReadyQueue(int capacityPerLevel) {
+    if (capacityPerLevel < 2) {
+        cerr << "ConcurrentReadyQueue: invalid capacity " << capacityPerLevel << ", using 2" << endl;
+        capacityPerLevel = 2;
+    }
+    size_t capacity = 2;
+    while (capacity < (size_t) capacityPerLevel) {
+        capacity *= 2;
+    }
+    for (unsigned int p = 0; p <= MAX_PRIORITY; p++) {
+        // Level 0 is never used, so it gets no ring
+        size_t n = (p == 0) ? 0 : capacity;
+        levels[p].cells = (n == 0) ? NULL : new Cell[n];
+        levels[p].mask = capacity - 1;
+        for (size_t i = 0; i < n; i++) {
+            levels[p].cells[i].seq.store(i, memory_order_relaxed);
+            levels[p].cells[i].pcb = NULL;
+        }
+        levels[p].enqueuePos.store(0, memory_order_relaxed);
+        levels[p].dequeuePos.store(0, memory_order_relaxed);
+    }
+    bitmap.store(0);
+    count.store(0);
+}
+
+/**
+ * @brief Destructor
+ */
+ConcurrentReadyQueue::~ConcurrentReadyQueue() {
+    // The PCBs are owned by the PCBTable; only the rings belong to the queue
+    for (unsigned int p = 0; p <= MAX_PRIORITY; p++) {
+        delete[] levels[p].cells;
+    }
+}
+
+/**
+ * @brief Append a PCB to the ring of one level.
+ * A cell is free for the producer at position pos when its seq equals pos. The producer claims the position
+ * with a CAS on enqueuePos, stores the PCB and publishes it by setting seq to pos + 1. A cell from the previous
+ * lap that a consumer has claimed but not yet handed back is waited for, not reported as full.
+ *
+ * @param level: the ring to append to
+ * @param pcb: the PCB to append
+ * @return bool: true on success, false if the ring is full
+ */
+bool ConcurrentReadyQueue::enqueue(Level &level, PCB *pcb) {
+    size_t pos = level.enqueuePos.load(memory_order_relaxed);
+    while (true) {
+        Cell &cell = level.cells[pos & level.mask];
+        size_t seq = cell.seq.load(memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0) {
+            if (level.enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                cell.pcb = pcb;
+                cell.seq.store(pos + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // The cell still belongs to the previous lap. The ring is full only if a whole lap of PCBs is
+            // queued; otherwise a consumer has claimed the cell and is about to hand it over, so try again.
+            // pos may be stale, with consumers already past it, so the distance is signed
+            if ((intptr_t) (pos - level.dequeuePos.load(memory_order_acquire)) > (intptr_t) level.mask) {
+                return false;
+            }
+            pos = level.enqueuePos.load(memory_order_relaxed);
+        } else {
+            pos = level.enqueuePos.load(memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Take the oldest PCB from the ring of one level.
+ * A cell at position pos holds a PCB when its seq equals pos + 1. The consumer claims the position with a CAS
+ * on dequeuePos, takes the PCB and hands the cell to the producer of the next lap by setting seq to pos + capacity.
+ *
+ * @param level: the ring to take from
+ * @return PCB*: the PCB, or NULL if the ring is empty
+ */
+PCB* ConcurrentReadyQueue::dequeue(Level &level) {
+    size_t pos = level.dequeuePos.load(memory_order_relaxed);
+    while (true) {
+        Cell &cell = level.cells[pos & level.mask];
+        size_t seq = cell.seq.load(memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+        if (diff == 0) {
+            if (level.dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                PCB *pcb = cell.pcb;
+                cell.seq.store(pos + level.mask + 1, memory_order_release);
+                return pcb;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = level.dequeuePos.load(memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Add a PCB representing a process into the ready queue. Lock-free and thread-safe.
+ *
+ * @param pcbPtr: the pointer to the PCB to be added
+ * @return bool: true on success, false if the PCB is invalid or its priority level is full
+ */
+bool ConcurrentReadyQueue::addPCB(PCB *pcbPtr) {
+    if (pcbPtr == NULL) {
+        cerr << "ConcurrentReadyQueue: cannot add a NULL PCB" << endl;
+        return false;
+    }
+    unsigned int priority = pcbPtr->getPriority();
+    if (priority < 1 || priority > MAX_PRIORITY) {
+        cerr << "ConcurrentReadyQueue: PCB " << pcbPtr->getID() << " has priority " << priority
+             << " outside the range 1-" << MAX_PRIORITY << endl;
+        return false;
+    }
+
+    // The state must be set before the PCB is published, since a consumer may take it right away
+    pcbPtr->setState(ProcState::READY);
+    if (!enqueue(levels[priority], pcbPtr)) {
+        cerr << "ConcurrentReadyQueue: priority level " << priority << " is full" << endl;
+        return false;
+    }
+    count.fetch_add(1, memory_order_relaxed);
+    bitmap.fetch_or((uint64_t)1 << priority);
+    return true;
+}
+
+/**
+ * @brief Remove and return the PCB with the highest priority from the queue. Lock-free and thread-safe.
+ * A PCB whose addPCB call has not returned yet may be missed.
+ *
+ * @return PCB*: the pointer to the PCB with the highest priority, or NULL if the queue is empty
+ */
+PCB* ConcurrentReadyQueue::removePCB() {
+    uint64_t bits = bitmap.load();
+    while (bits != 0) {
+        int p = highest_bit(bits);
+        PCB *pcb = dequeue(levels[p]);
+        if (pcb != NULL) {
+            count.fetch_sub(1, memory_order_relaxed);
+            // When removing a PCB from the queue, its state becomes RUNNING.
+            pcb->setState(ProcState::RUNNING);
+            return pcb;
+        }
+        // The level looks empty. Clear its bit, then check again in case a producer added a PCB and set the
+        // bit before we cleared it; that producer's PCB is visible to us now, so restore the bit for it.
+        uint64_t bit = (uint64_t)1 << p;
+        bitmap.fetch_and(~bit);
+        pcb = dequeue(levels[p]);
+        if (pcb != NULL) {
+            bitmap.fetch_or(bit);
+            count.fetch_sub(1, memory_order_relaxed);
+            pcb->setState(ProcState::RUNNING);
+            return pcb;
+        }
+        bits = bitmap.load();
+    }
+    return NULL;
+}
+
+/**
+ * @brief Returns the number of elements in the queue. Exact only while no thread is modifying the queue.
+ *
+ * @return int: the number of PCBs in the queue
+ */
+int ConcurrentReadyQueue::size() {
+    return count.load(memory_order_relaxed);
+}
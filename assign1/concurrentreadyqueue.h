@@ -0,0 +1,111 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file concurrentreadyqueue.h
+ * @brief ConcurrentReadyQueue is a ready queue that any number of threads can add to and remove from
+ * at the same time without taking a lock.
+ * @version 0.1
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "pcb.h"
+
+/**
+ * @brief A lock-free multi-producer, multi-consumer priority queue of PCBs.
+ *
+ * It has the same layout as ReadyQueue: one FIFO per priority level and a 64-bit occupancy bitmap whose
+ * highest set bit selects the level to dispatch from. Each level is a bounded ring buffer in which every
+ * cell carries a sequence number (Vyukov's MPMC queue), so producers and consumers claim cells with a
+ * single compare-and-swap and never block each other.
+ *
+ * A producer sets the level's bitmap bit after its PCB is in the ring. A consumer that finds a level empty
+ * clears the bit and then looks at the ring again, restoring the bit if a producer got in between, so a
+ * queued PCB is never hidden from consumers.
+ */
+class ConcurrentReadyQueue {
+public:
+    // The largest priority accepted by the queue. Valid priorities are 1..MAX_PRIORITY.
+    static const unsigned int MAX_PRIORITY = 50;
+
+private:
+    static_assert(MAX_PRIORITY < 64, "the occupancy bitmap has one bit per priority level");
+
+    // One slot of a ring. seq tells producers and consumers whose turn it is to use the slot.
+    struct Cell {
+        std::atomic<size_t> seq;
+        PCB *pcb;
+    };
+
+    // The ring buffer of one priority level. The two positions live on separate cache lines
+    // so that producers and consumers do not false-share.
+    struct Level {
+        Cell *cells;
+        size_t mask;
+        alignas(64) std::atomic<size_t> enqueuePos;
+        alignas(64) std::atomic<size_t> dequeuePos;
+    };
+
+    // One ring per priority level. Index 0 is unused since priorities start at 1.
+    Level levels[MAX_PRIORITY + 1];
+    // Bit p is set while levels[p] may be non-empty
+    alignas(64) std::atomic<uint64_t> bitmap;
+    // Number of PCBs in the queue
+    alignas(64) std::atomic<int> count;
+
+    /**
+     * @brief Append a PCB to the ring of one level.
+     *
+     * @return bool: true on success, false if the ring is full
+     */
+    bool enqueue(Level &level, PCB *pcb);
+
+    /**
+     * @brief Take the oldest PCB from the ring of one level.
+     *
+     * @return PCB*: the PCB, or NULL if the ring is empty
+     */
+    PCB* dequeue(Level &level);
+
+public:
+    /**
+     * @brief Construct a new ConcurrentReadyQueue object
+     *
+     * @param capacityPerLevel: the maximum number of PCBs queued at one priority level. It is rounded up to
+     * a power of two.
+     */
+    ConcurrentReadyQueue(int capacityPerLevel = 1024);
+
+    /**
+     * @brief Destructor
+     */
+    ~ConcurrentReadyQueue();
+
+    // The rings hold atomics, so copying is not supported
+    ConcurrentReadyQueue(const ConcurrentReadyQueue &) = delete;
+    ConcurrentReadyQueue &operator=(const ConcurrentReadyQueue &) = delete;
+
+    /**
+     * @brief Add a PCB representing a process into the ready queue. Lock-free and thread-safe.
+     *
+     * @param pcbPtr: the pointer to the PCB to be added
+     * @return bool: true on success, false if the PCB is invalid or its priority level is full
+     */
+    bool addPCB(PCB *pcbPtr);
+
+    /**
+     * @brief Remove and return the PCB with the highest priority from the queue. Lock-free and thread-safe.
+     * A PCB whose addPCB call has not returned yet may be missed.
+     *
+     * @return PCB*: the pointer to the PCB with the highest priority, or NULL if the queue is empty
+     */
+    PCB* removePCB();
+
+    /**
+     * @brief Returns the number of elements in the queue. Exact only while no thread is modifying the queue.
+     *
+     * @return int: the number of PCBs in the queue
+     */
+    int size();
+};
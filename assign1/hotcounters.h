@@ -0,0 +1,109 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file hotcounters.h
+ * @brief Optional event counters for the hot paths of ReadyQueue and PCBTable.
+ * Build with -DSCHED_STATS (make STATS=-DSCHED_STATS) to turn them on. Without it the counters and every
+ * update to them are compiled out, and the stats() accessors return zeros.
+ * @version 0.1
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef SCHED_STATS
+// Run a counter update; expands to nothing when the counters are compiled out
+#define SCHED_COUNT(stmt) stmt
+#else
+#define SCHED_COUNT(stmt)
+#endif
+
+// Whether this build keeps the counters
+static constexpr bool SCHED_STATS_ENABLED =
+#ifdef SCHED_STATS
+    true;
+#else
+    false;
+#endif
+
+// Number of per-thread slots in each set of counters. Threads beyond this share slots.
+static const unsigned int STAT_SLOTS = 16;
+
+/**
+ * @brief The counter slot of the calling thread. Threads are given slots in the order they first count
+ * something.
+ */
+inline unsigned int statSlot() {
+    static std::atomic<unsigned int> nextSlot(0);
+    thread_local unsigned int slot = nextSlot.fetch_add(1, std::memory_order_relaxed) % STAT_SLOTS;
+    return slot;
+}
+
+/**
+ * @brief N event counters kept per thread, each thread's on its own cache lines, so counting is a plain
+ * load and store to a line no other thread writes. A reader adds the slots up at any time without stopping
+ * the writers; the counts it sees may be a few events behind.
+ *
+ * Updates are not atomic read-modify-writes, so once more than STAT_SLOTS threads count into the same set,
+ * the threads that share a slot can occasionally lose an increment.
+ */
+template <unsigned int N>
+class HotCounters {
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value[N];
+    };
+    Slot slots[STAT_SLOTS];
+
+public:
+    HotCounters() {
+        for (unsigned int s = 0; s < STAT_SLOTS; s++) {
+            for (unsigned int i = 0; i < N; i++) {
+                slots[s].value[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Add to a counter of the calling thread.
+     */
+    void add(unsigned int counter, uint64_t n = 1) {
+        std::atomic<uint64_t> &c = slots[statSlot()].value[counter];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Raise a high-water mark of the calling thread to v if it is lower.
+     */
+    void max(unsigned int counter, uint64_t v) {
+        std::atomic<uint64_t> &c = slots[statSlot()].value[counter];
+        if (v > c.load(std::memory_order_relaxed)) {
+            c.store(v, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief The total of a counter over all threads.
+     */
+    uint64_t sum(unsigned int counter) const {
+        uint64_t total = 0;
+        for (unsigned int s = 0; s < STAT_SLOTS; s++) {
+            total += slots[s].value[counter].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief The highest value of a high-water mark over all threads.
+     */
+    uint64_t maximum(unsigned int counter) const {
+        uint64_t m = 0;
+        for (unsigned int s = 0; s < STAT_SLOTS; s++) {
+            uint64_t v = slots[s].value[counter].load(std::memory_order_relaxed);
+            if (v > m) {
+                m = v;
+            }
+        }
+        return m;
+    }
+};
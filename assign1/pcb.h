@@ -44,11 +44,8 @@ public:
         this->state = state;
     }
 
-    /**
-     * @brief Destroy the PCB object.
-     *
-     */
-    ~PCB() {}
+    // No destructor is declared, so a PCB stays trivially copyable and can be written to and mapped from a
+    // PCBSnapshot as raw bytes
 
     /**
      * @brief Get the ID of the PCB.
@@ -82,7 +79,7 @@ public:
      * @param state
      */
     void setState(ProcState state) {
-        // TODO: add your code here
+        this->state = state;
     }
 
     /**
@@ -90,7 +87,7 @@ public:
      * @param priority
      */
     void setPriority(unsigned int priority) {
-        // TODO: add your code here
+        this->priority = priority;
     }
 
     /**
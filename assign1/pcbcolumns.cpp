@@ -0,0 +1,162 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file pcbcolumns.cpp
+ * @brief This is the implementation file for the PCBColumns class.
+ */
+#include "pcbcolumns.h"
+
+/**
+ * @brief Construct a new PCBColumns object with the given number of empty slots
+ *
+ * @param size: the number of slots
+ */
+PCBColumns::PCBColumns(int size) {
+    if (size < 0) {
+        cerr << "PCBColumns: invalid size " << size << ", using 0" << endl;
+        size = 0;
+    }
+    ids.assign(size, 0);
+    priorities.assign(size, 0);
+    states.assign(size, EMPTY);
+}
+
+/**
+ * @brief Replace the contents with a copy of every PCB in a PCBTable, keeping the slot indexes.
+ *
+ * @param table: the table to copy
+ */
+void PCBColumns::load(PCBTable &table) {
+    int size = table.capacity();
+    ids.assign(size, 0);
+    priorities.assign(size, 0);
+    states.assign(size, EMPTY);
+    for (int i = 0; i < size; i++) {
+        PCB *pcb = table.getPCB((unsigned int) i);
+        if (pcb != NULL) {
+            set(i, pcb->getID(), pcb->getPriority(), pcb->getState());
+        }
+    }
+}
+
+/**
+ * @brief Fill one slot.
+ *
+ * @param idx: the slot, which must be less than size()
+ * @param pid: the process ID
+ * @param priority: the priority in the range 1-50
+ * @param state: the process state
+ */
+void PCBColumns::set(unsigned int idx, unsigned int pid, unsigned int priority, ProcState state) {
+    ids[idx] = pid;
+    priorities[idx] = (uint8_t) priority;
+    states[idx] = (uint8_t) state;
+}
+
+/**
+ * @brief Count the processes in a given state.
+ *
+ * @param state: the state to count
+ * @return int: the number of processes in that state
+ */
+int PCBColumns::countByState(ProcState state) {
+    const uint8_t s = (uint8_t) state;
+    const uint8_t *st = states.data();
+    size_t n = states.size();
+    // Accumulate in 32 bits: a byte accumulator would vectorize wider but overflow after 255 matches
+    uint32_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        count += (st[i] == s);
+    }
+    return (int) count;
+}
+
+/**
+ * @brief Find the highest priority among the processes in a given state.
+ *
+ * @param state: the state to look at
+ * @return unsigned int: the highest priority, or 0 if no process is in that state
+ */
+unsigned int PCBColumns::maxPriority(ProcState state) {
+    const uint8_t s = (uint8_t) state;
+    const uint8_t *st = states.data();
+    const uint8_t *pr = priorities.data();
+    size_t n = states.size();
+    uint8_t best = 0;
+    for (size_t i = 0; i < n; i++) {
+        // Mask out priorities of other states: all ones on a match, zero otherwise
+        uint8_t p = pr[i] & (uint8_t) -(st[i] == s);
+        best = (p > best) ? p : best;
+    }
+    return best;
+}
+
+/**
+ * @brief Collect the slots whose priority is within [low, high].
+ * The index is always written and the output position only advances on a match, which avoids a
+ * mispredicted branch per slot when matches are random.
+ *
+ * @param low: the lowest priority to include
+ * @param high: the highest priority to include
+ * @param out: receives the matching slot indexes in increasing order; previous contents are discarded
+ * @return int: the number of matching slots
+ */
+int PCBColumns::filterByPriority(unsigned int low, unsigned int high, vector<uint32_t> &out) {
+    // Priority 0 marks empty slots
+    if (low < 1) {
+        low = 1;
+    }
+    if (high < low) {
+        out.clear();
+        return 0;
+    }
+    size_t n = priorities.size();
+    out.resize(n);
+    const uint8_t *pr = priorities.data();
+    uint32_t *dst = out.data();
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        dst[k] = (uint32_t) i;
+        // Unsigned wrap-around turns the range check into a single comparison
+        k += ((unsigned int) pr[i] - low <= high - low);
+    }
+    out.resize(k);
+    return (int) k;
+}
+
+/**
+ * @brief Move every process in state "from" to state "to", e.g. wake up all WAITING processes, both in
+ * the columns and in the PCBs of the table they were loaded from.
+ * The state column is scanned and rewritten without branches, collecting the changed slots the way
+ * filterByPriority does; only the PCBs of those slots are then visited to write the new state back.
+ *
+ * @param from: the state to change
+ * @param to: the new state
+ * @param table: the table the columns were loaded from, with the same slots
+ * @return int: the number of processes that changed state, or -1 if the table has a different size
+ */
+int PCBColumns::transitionState(ProcState from, ProcState to, PCBTable &table) {
+    if (table.capacity() != size()) {
+        cerr << "PCBColumns: table has " << table.capacity() << " slots, columns have " << size() << endl;
+        return -1;
+    }
+    const uint8_t f = (uint8_t) from;
+    const uint8_t t = (uint8_t) to;
+    uint8_t *st = states.data();
+    size_t n = states.size();
+    changed.resize(n);
+    uint32_t *dst = changed.data();
+    size_t k = 0;
+    for (size_t i = 0; i < n; i++) {
+        bool match = (st[i] == f);
+        dst[k] = (uint32_t) i;
+        k += match;
+        st[i] = match ? t : st[i];
+    }
+    for (size_t j = 0; j < k; j++) {
+        PCB *pcb = table.getPCB(dst[j]);
+        if (pcb != NULL) {
+            pcb->setState(to);
+        }
+    }
+    return (int) k;
+}
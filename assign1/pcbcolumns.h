@@ -0,0 +1,148 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file pcbcolumns.h
+ * @brief PCBColumns stores the PCBs of a table as a structure of arrays, for fast queries over all processes.
+ * @version 0.1
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pcb.h"
+#include "pcbtable.h"
+
+/**
+ * @brief A structure-of-arrays copy of the PCB fields: one packed array of ids, one of priorities and
+ * one of 1-byte states, all indexed by slot.
+ *
+ * Queries such as "how many processes are READY" or "highest priority among WAITING processes" only read
+ * the columns they need, sequentially, instead of following one pointer per PCB. The scans are written
+ * without branches on the data so that the compiler vectorizes them (see the -O3 flag in the Makefile);
+ * with 1-byte states and priorities a 16-byte vector covers 16 processes.
+ *
+ * Priorities are stored in a byte, which holds the PCB range 1-50. Empty slots have priority 0 and the
+ * state EMPTY, so they never match a query.
+ *
+ * The columns are a copy taken by load, and nothing keeps them in sync with the table. A change made after
+ * load through the table (addPCB, allocPCB, releasePCB, ...), a PCB (setState, setPriority) or a ReadyQueue
+ * is not seen by the queries, which then return stale answers without any error. Call load again, or
+ * repeat the change with set/setState, before querying. Only transitionState changes both sides.
+ */
+class PCBColumns {
+public:
+    // State of a slot that holds no process. It is outside the range of ProcState.
+    static constexpr uint8_t EMPTY = 0xFF;
+
+private:
+    // The process ID of each slot
+    vector<uint32_t> ids;
+    // The priority of each slot, 0 for empty slots
+    vector<uint8_t> priorities;
+    // The ProcState of each slot as a byte, or EMPTY
+    vector<uint8_t> states;
+    // Slots changed by the last transitionState, reused so that it does not allocate
+    vector<uint32_t> changed;
+
+public:
+    /**
+     * @brief Construct a new PCBColumns object with the given number of empty slots
+     *
+     * @param size: the number of slots
+     */
+    PCBColumns(int size = 0);
+
+    /**
+     * @brief Replace the contents with a copy of every PCB in a PCBTable, keeping the slot indexes. The copy
+     * is only valid until the table or its PCBs change.
+     *
+     * @param table: the table to copy
+     */
+    void load(PCBTable &table);
+
+    /**
+     * @brief Fill one slot.
+     *
+     * @param idx: the slot, which must be less than size()
+     * @param pid: the process ID
+     * @param priority: the priority in the range 1-50
+     * @param state: the process state
+     */
+    void set(unsigned int idx, unsigned int pid, unsigned int priority, ProcState state);
+
+    /**
+     * @brief Change the state of one slot.
+     *
+     * @param idx: the slot, which must be less than size()
+     * @param state: the new state
+     */
+    void setState(unsigned int idx, ProcState state) {
+        states[idx] = (uint8_t) state;
+    }
+
+    /**
+     * @brief Returns the number of slots.
+     *
+     * @return int: the number of slots
+     */
+    int size() {
+        return (int) states.size();
+    }
+
+    /**
+     * @brief Get the process ID of one slot.
+     */
+    unsigned int getID(unsigned int idx) {
+        return ids[idx];
+    }
+
+    /**
+     * @brief Get the priority of one slot, 0 if it is empty.
+     */
+    unsigned int getPriority(unsigned int idx) {
+        return priorities[idx];
+    }
+
+    /**
+     * @brief Get the state of one slot. Only meaningful for slots that are not empty.
+     */
+    ProcState getState(unsigned int idx) {
+        return (ProcState) states[idx];
+    }
+
+    /**
+     * @brief Count the processes in a given state.
+     *
+     * @param state: the state to count
+     * @return int: the number of processes in that state
+     */
+    int countByState(ProcState state);
+
+    /**
+     * @brief Find the highest priority among the processes in a given state.
+     *
+     * @param state: the state to look at
+     * @return unsigned int: the highest priority, or 0 if no process is in that state
+     */
+    unsigned int maxPriority(ProcState state);
+
+    /**
+     * @brief Collect the slots whose priority is within [low, high].
+     *
+     * @param low: the lowest priority to include
+     * @param high: the highest priority to include
+     * @param out: receives the matching slot indexes in increasing order; previous contents are discarded
+     * @return int: the number of matching slots
+     */
+    int filterByPriority(unsigned int low, unsigned int high, vector<uint32_t> &out);
+
+    /**
+     * @brief Move every process in state "from" to state "to", e.g. wake up all WAITING processes, both in
+     * the columns and in the PCBs of the table they were loaded from.
+     *
+     * @param from: the state to change
+     * @param to: the new state
+     * @param table: the table the columns were loaded from, with the same slots
+     * @return int: the number of processes that changed state, or -1 if the table has a different size
+     */
+    int transitionState(ProcState from, ProcState to, PCBTable &table);
+};
@@ -0,0 +1,370 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file pcbsnapshot.cpp
+ * @brief This is the implementation file for the PCBSnapshot class.
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pcbsnapshot.h"
+
+// The slab is written and mapped as raw bytes
+static_assert(std::is_standard_layout<PCB>::value && std::is_trivially_copyable<PCB>::value,
+              "PCB must have a plain memory layout to be snapshotted");
+
+static const char SNAPSHOT_MAGIC[8] = {'P', 'C', 'B', 'S', 'N', 'A', 'P', '\0'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+
+// Sections start on cache line boundaries, which also satisfies the alignment of every section type
+static const uint64_t SECTION_ALIGN = 64;
+
+/**
+ * @brief The first bytes of a snapshot file. The offsets are from the start of the file.
+ */
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    // sizeof(PCB) and sizeof(PIDIndex::Entry) of the writer, to reject files from a different layout
+    uint32_t pcbSize;
+    uint32_t entrySize;
+    // Number of slots and of occupied slots in the table
+    uint32_t capacity;
+    uint32_t live;
+    // Number of buckets and of entries in the PID index
+    uint32_t pidCapacity;
+    uint32_t pidSize;
+    // Number of queued PCBs
+    uint32_t queued;
+    // Keeps the offsets 8-byte aligned without implicit padding, so headers can be compared bytewise
+    uint32_t reserved;
+    uint64_t slabOffset;
+    uint64_t generationsOffset;
+    uint64_t occupiedOffset;
+    uint64_t pidsOffset;
+    uint64_t queueOffset;
+    uint64_t fileSize;
+};
+
+/**
+ * @brief Round an offset up to the next section boundary.
+ */
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+}
+
+/**
+ * @brief Lay out the sections of a snapshot. The counts in the header must be set.
+ *
+ * @param h: the header whose offsets and file size are filled in
+ */
+static void layoutSections(SnapshotHeader &h) {
+    uint64_t offset = alignSection(sizeof(SnapshotHeader));
+    h.slabOffset = offset;
+    offset = alignSection(offset + (uint64_t) h.capacity * h.pcbSize);
+    h.generationsOffset = offset;
+    offset = alignSection(offset + (uint64_t) h.capacity * sizeof(uint16_t));
+    h.occupiedOffset = offset;
+    offset = alignSection(offset + h.capacity);
+    h.pidsOffset = offset;
+    offset = alignSection(offset + (uint64_t) h.pidCapacity * h.entrySize);
+    h.queueOffset = offset;
+    h.fileSize = offset + (uint64_t) h.queued * sizeof(uint32_t);
+}
+
+/**
+ * @brief Write a whole buffer to a file descriptor, retrying short writes.
+ *
+ * @return bool: true if every byte was written
+ */
+static bool writeAll(int fd, const char *data, uint64_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+/**
+ * @brief Write a snapshot of a table and a queue.
+ *
+ * @param path: the snapshot file
+ * @param table: the PCB table
+ * @param queue: a ready queue holding PCBs of the table
+ * @return bool: true on success, false if a queued PCB is not in the table or not READY, or the file cannot be
+ * written
+ */
+bool PCBSnapshot::save(const char *path, PCBTable &table, ReadyQueue &queue) {
+    // Only the current bucket array is saved, so a resize in progress is completed first
+    table.pids.finishResize();
+
+    uint32_t capacity = (uint32_t) table.table.size();
+    std::vector<PCB *> queued(queue.size());
+    queue.listPCBs(queued.data());
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.pcbSize = sizeof(PCB);
+    h.entrySize = sizeof(PIDIndex::Entry);
+    h.capacity = capacity;
+    h.live = table.live;
+    h.pidCapacity = table.pids.current.capacity;
+    h.pidSize = table.pids.current.size;
+    h.queued = (uint32_t) queued.size();
+    layoutSections(h);
+
+    // Empty slots and the padding between sections stay zero
+    char *image = (char *) calloc(h.fileSize, 1);
+    if (image == NULL) {
+        cerr << "PCBSnapshot: cannot allocate " << h.fileSize << " bytes for the snapshot" << endl;
+        return false;
+    }
+    memcpy(image, &h, sizeof(h));
+    PCB *slab = (PCB *) (image + h.slabOffset);
+    uint8_t *occupied = (uint8_t *) (image + h.occupiedOffset);
+    for (uint32_t i = 0; i < capacity; i++) {
+        // Heap PCBs handed over with addPCB are saved into the slab like the others
+        if (table.table[i] != NULL) {
+            slab[i] = *table.table[i];
+            occupied[i] = 1;
+        }
+    }
+    memcpy(image + h.generationsOffset, table.generations.data(), (size_t) capacity * sizeof(uint16_t));
+    memcpy(image + h.pidsOffset, table.pids.current.entries, (size_t) h.pidCapacity * h.entrySize);
+
+    uint32_t *slots = (uint32_t *) (image + h.queueOffset);
+    for (uint32_t i = 0; i < h.queued; i++) {
+        PCB *pcb = queued[i];
+        uint32_t slot;
+        if (pcb >= table.slab && pcb < table.slab + capacity) {
+            slot = (uint32_t) (pcb - table.slab);
+        } else if (!table.pids.find(pcb->getID(), slot) || table.table[slot] != pcb) {
+            cerr << "PCBSnapshot: queued PCB " << pcb->getID() << " is not in the table" << endl;
+            free(image);
+            return false;
+        }
+        // load would refuse a queue that addPCBs cannot restore as it is
+        if (pcb->getState() != ProcState::READY || pcb->getPriority() < 1 ||
+            pcb->getPriority() > ReadyQueue::MAX_PRIORITY) {
+            cerr << "PCBSnapshot: queued PCB " << pcb->getID() << " is not READY with a priority in the range 1-"
+                 << ReadyQueue::MAX_PRIORITY << endl;
+            free(image);
+            return false;
+        }
+        slots[i] = slot;
+    }
+
+    // Write under a temporary name and rename, so a crash never leaves a torn snapshot behind
+    std::string tmp = std::string(path) + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        cerr << "PCBSnapshot: cannot create " << tmp << ": " << strerror(errno) << endl;
+        free(image);
+        return false;
+    }
+    bool ok = writeAll(fd, image, h.fileSize) && fsync(fd) == 0;
+    if (!ok) {
+        cerr << "PCBSnapshot: cannot write " << tmp << ": " << strerror(errno) << endl;
+    }
+    close(fd);
+    free(image);
+    if (ok && rename(tmp.c_str(), path) != 0) {
+        cerr << "PCBSnapshot: cannot rename " << tmp << " to " << path << ": " << strerror(errno) << endl;
+        ok = false;
+    }
+    if (!ok) {
+        unlink(tmp.c_str());
+    }
+    return ok;
+}
+
+/**
+ * @brief Check that a mapped snapshot is complete, was written with the same layout, that its PID index
+ * covers every occupied slot, and that its queue only holds occupied slots with READY PCBs of a valid priority.
+ *
+ * @param base: the start of the mapping
+ * @param length: the length of the file
+ * @return bool: true if the header and every section are consistent
+ */
+bool PCBSnapshot::validSnapshot(const char *base, uint64_t length) {
+    if (length < sizeof(SnapshotHeader)) {
+        return false;
+    }
+    const SnapshotHeader &h = *(const SnapshotHeader *) base;
+    if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 || h.version != SNAPSHOT_VERSION ||
+        h.pcbSize != sizeof(PCB) || h.entrySize != sizeof(PIDIndex::Entry)) {
+        return false;
+    }
+    if (h.capacity > ((uint32_t) 1 << PCBTable::INDEX_BITS) - 1 || h.live > h.capacity || h.queued > h.live ||
+        h.pidSize != h.live || h.pidCapacity == 0 || (h.pidCapacity & (h.pidCapacity - 1)) != 0 ||
+        h.pidSize >= h.pidCapacity) {
+        return false;
+    }
+    // The offsets are recomputed rather than trusted
+    SnapshotHeader expected = h;
+    layoutSections(expected);
+    if (memcmp(&expected, &h, sizeof(h)) != 0 || h.fileSize != length) {
+        return false;
+    }
+    const PCB *slab = (const PCB *) (base + h.slabOffset);
+    const uint8_t *occupied = (const uint8_t *) (base + h.occupiedOffset);
+    uint32_t live = 0;
+    for (uint32_t i = 0; i < h.capacity; i++) {
+        if (occupied[i] > 1) {
+            return false;
+        }
+        live += occupied[i];
+    }
+    if (live != h.live) {
+        return false;
+    }
+
+    // Every entry of the PID index names a distinct occupied slot holding that PID, and sits where a probe
+    // from its home bucket finds it
+    std::vector<uint8_t> seen(h.capacity, 0);
+    PIDIndex::Table t;
+    t.capacity = h.pidCapacity;
+    t.bits = 0;
+    while (((uint32_t) 1 << t.bits) < h.pidCapacity) {
+        t.bits++;
+    }
+    const PIDIndex::Entry *entries = (const PIDIndex::Entry *) (base + h.pidsOffset);
+    uint32_t pidSize = 0;
+    for (uint32_t i = 0; i < h.pidCapacity; i++) {
+        const PIDIndex::Entry &e = entries[i];
+        if (e.probe == 0) {
+            continue;
+        }
+        if (e.probe < 0 || (uint32_t) e.probe > h.pidCapacity || e.value >= h.capacity ||
+            !occupied[e.value] || seen[e.value] || slab[e.value].id != e.pid ||
+            ((PIDIndex::home(t, e.pid) + (uint32_t) e.probe - 1) & (h.pidCapacity - 1)) != i) {
+            return false;
+        }
+        seen[e.value] = 1;
+        pidSize++;
+    }
+    if (pidSize != h.pidSize) {
+        return false;
+    }
+
+    // Every queued slot is occupied, queued once, and holds a READY PCB that the queue accepts, so that
+    // addPCBs restores all of them
+    std::fill(seen.begin(), seen.end(), 0);
+    const uint32_t *slots = (const uint32_t *) (base + h.queueOffset);
+    for (uint32_t i = 0; i < h.queued; i++) {
+        uint32_t slot = slots[i];
+        if (slot >= h.capacity || !occupied[slot] || seen[slot] || slab[slot].state != ProcState::READY ||
+            slab[slot].priority < 1 || slab[slot].priority > ReadyQueue::MAX_PRIORITY) {
+            return false;
+        }
+        seen[slot] = 1;
+    }
+    return true;
+}
+
+/**
+ * @brief Replace the contents of a table with a snapshot and queue the PCBs that were queued when it was
+ * taken.
+ *
+ * @param path: the snapshot file
+ * @param table: the PCB table to restore into
+ * @param queue: an empty ready queue
+ * @return bool: true on success, false if the file is missing, malformed or the queue is not empty
+ */
+bool PCBSnapshot::load(const char *path, PCBTable &table, ReadyQueue &queue) {
+    if (queue.size() != 0) {
+        cerr << "PCBSnapshot: the ready queue must be empty before a snapshot is loaded" << endl;
+        return false;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        cerr << "PCBSnapshot: cannot open " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(SnapshotHeader)) {
+        cerr << "PCBSnapshot: " << path << " is not a snapshot" << endl;
+        close(fd);
+        return false;
+    }
+    // A private writable mapping: the PCBs can be changed in place and the changes never reach the file
+    void *mapped = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        cerr << "PCBSnapshot: cannot map " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    char *base = (char *) mapped;
+    if (!validSnapshot(base, st.st_size)) {
+        cerr << "PCBSnapshot: " << path << " is damaged or was written by an incompatible build" << endl;
+        munmap(mapped, st.st_size);
+        return false;
+    }
+    const SnapshotHeader &h = *(const SnapshotHeader *) base;
+
+    // Drop the current contents of the table and adopt the mapped slab
+    for (size_t i = 0; i < table.table.size(); i++) {
+        if (table.table[i] != NULL) {
+            table.clearSlot(i);
+        }
+    }
+    table.releaseSlab();
+    table.slab = (PCB *) (base + h.slabOffset);
+    table.mapping = mapped;
+    table.mappingLength = st.st_size;
+
+    const uint16_t *generations = (const uint16_t *) (base + h.generationsOffset);
+    const uint8_t *occupied = (const uint8_t *) (base + h.occupiedOffset);
+    table.table.assign(h.capacity, NULL);
+    table.generations.assign(generations, generations + h.capacity);
+    table.onFreeList.assign(h.capacity, false);
+    table.freeSlots.clear();
+    table.freeSlots.reserve(h.capacity);
+    // Walk down so that allocPCB hands out the lowest free slots first, as in a new table
+    int live = 0;
+    for (uint32_t i = h.capacity; i-- > 0;) {
+        if (occupied[i]) {
+            table.table[i] = &table.slab[i];
+            live++;
+        } else {
+            table.onFreeList[i] = true;
+            table.freeSlots.push_back(i);
+        }
+    }
+    table.live = live;
+
+    PIDIndex &pids = table.pids;
+    free(pids.current.entries);
+    free(pids.old.entries);
+    pids.old.entries = NULL;
+    pids.old.capacity = 0;
+    pids.old.size = 0;
+    pids.cursor = 0;
+    PIDIndex::initTable(pids.current, h.pidCapacity);
+    memcpy(pids.current.entries, base + h.pidsOffset, (size_t) h.pidCapacity * h.entrySize);
+    pids.current.size = h.pidSize;
+
+    const uint32_t *slots = (const uint32_t *) (base + h.queueOffset);
+    std::vector<PCB *> queued(h.queued);
+    for (uint32_t i = 0; i < h.queued; i++) {
+        queued[i] = &table.slab[slots[i]];
+    }
+    queue.addPCBs(queued.data(), (int) h.queued);
+    return true;
+}
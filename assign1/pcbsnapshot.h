@@ -0,0 +1,62 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file pcbsnapshot.h
+ * @brief PCBSnapshot saves a PCBTable and the contents of a ReadyQueue to a binary file and restores them.
+ * @version 0.1
+ */
+#pragma once
+
+#include "pcbtable.h"
+#include "readyqueue.h"
+
+/**
+ * @brief Binary snapshots of a PCBTable and a ReadyQueue for fast restart.
+ *
+ * The file is the in-memory layout of the table: the PCB slab, the slot generations, a byte per slot that
+ * says whether it is occupied, the buckets of the PID index, and the slots of the queued PCBs in dispatch
+ * order. save builds the image in memory and writes it with one sequential write. load maps the file
+ * privately and makes the mapped slab the table's slab, so no PCB is allocated, constructed or parsed; the
+ * remaining work is a pass over the occupancy bytes, a copy of the PID index and relinking the queue.
+ * Changes made after load stay in memory and never reach the file.
+ *
+ * The format is tied to the PCB layout of the program that wrote it; load rejects files whose header
+ * does not match.
+ */
+class PCBSnapshot {
+public:
+    /**
+     * @brief Write a snapshot of a table and a queue. The file is written under a temporary name and renamed
+     * into place, so an existing snapshot is never left half-written.
+     *
+     * @param path: the snapshot file
+     * @param table: the PCB table
+     * @param queue: a ready queue holding PCBs of the table
+     * @return bool: true on success, false if a queued PCB is not in the table or not READY, or the file cannot be
+     * written
+     */
+    static bool save(const char *path, PCBTable &table, ReadyQueue &queue);
+
+    /**
+     * @brief Replace the contents of a table with a snapshot and queue the PCBs that were queued when it was
+     * taken. Any PCBs already in the table are removed first.
+     *
+     * @param path: the snapshot file
+     * @param table: the PCB table to restore into
+     * @param queue: an empty ready queue
+     * @return bool: true on success, false if the file is missing, malformed or the queue is not empty;
+     * the table is only modified on success
+     */
+    static bool load(const char *path, PCBTable &table, ReadyQueue &queue);
+
+private:
+    /**
+     * @brief Check that a mapped snapshot is complete, was written with the same layout, that its PID index
+     * covers every occupied slot, and that its queue only holds occupied slots with READY PCBs of a valid
+     * priority.
+     *
+     * @param base: the start of the mapping
+     * @param length: the length of the file
+     * @return bool: true if the header and every section are consistent
+     */
+    static bool validSnapshot(const char *base, uint64_t length);
+};
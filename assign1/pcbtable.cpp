@@ -7,15 +7,37 @@
  * // Remember to add sufficient comments to your code
  */
 
+#include <sys/mman.h>
 #include "pcbtable.h"
 
+const PCBTable::Handle PCBTable::INVALID_HANDLE = {0xFFFFFFFF};
+
 /**
  * @brief Construct a new PCBTable object of the given size (number of PCBs)
  *
  * @param size: the capacity of the PCBTable
  */
 PCBTable::PCBTable(int size) {
-   // TODO: add your code here
+    if (size < 0) {
+        cerr << "PCBTable: invalid size " << size << ", using 0" << endl;
+        size = 0;
+    }
+    if ((uint32_t) size > INDEX_MASK) {
+        cerr << "PCBTable: size " << size << " exceeds the handle limit, using " << INDEX_MASK << endl;
+        size = INDEX_MASK;
+    }
+    table.assign(size, NULL);
+    slab = new PCB[size];
+    mapping = NULL;
+    mappingLength = 0;
+    generations.assign(size, 0);
+    onFreeList.assign(size, true);
+    // Push in reverse so that allocPCB hands out the lowest slots first
+    freeSlots.reserve(size);
+    for (int i = size - 1; i >= 0; i--) {
+        freeSlots.push_back(i);
+    }
+    live = 0;
 }
 
 /**
@@ -23,8 +45,92 @@ PCBTable::PCBTable(int size) {
  *
  */
 PCBTable::~PCBTable() {
-   // TODO: add your code here
-   // Delete all the PCBs in the table
+    for (size_t i = 0; i < table.size(); i++) {
+        if (table[i] != NULL) {
+            clearSlot(i);
+        }
+    }
+    table.clear();
+    releaseSlab();
+}
+
+/**
+ * @brief Free the slab, whether it was allocated or mapped from a snapshot. The slots must be empty.
+ */
+void PCBTable::releaseSlab() {
+    if (mapping != NULL) {
+        munmap(mapping, mappingLength);
+        mapping = NULL;
+        mappingLength = 0;
+    } else {
+        delete[] slab;
+    }
+    slab = NULL;
+}
+
+/**
+ * @brief Empty a slot, deleting its PCB if it is not part of the slab, and invalidate its handles.
+ * The slot goes back on the free list.
+ *
+ * @param idx: an occupied slot
+ */
+void PCBTable::clearSlot(unsigned int idx) {
+    // IDs are unique within the table, so the index entry of this ID is this slot's
+    pids.erase(table[idx]->getID());
+    if (table[idx] != &slab[idx]) {
+        delete table[idx];
+    }
+    table[idx] = NULL;
+    generations[idx] = (generations[idx] + 1) & GENERATION_MASK;
+    live--;
+    SCHED_COUNT(counters.add(STAT_RELEASES));
+    if (!onFreeList[idx]) {
+        onFreeList[idx] = true;
+        freeSlots.push_back(idx);
+    }
+}
+
+/**
+ * @brief Put a PCB into an empty slot and index it by its ID.
+ *
+ * @param idx: an empty slot
+ * @param pcb: the PCB to store
+ */
+void PCBTable::fillSlot(unsigned int idx, PCB *pcb) {
+    table[idx] = pcb;
+    live++;
+    pids.insert(pcb->getID(), idx);
+    SCHED_COUNT(counters.add(STAT_FILLS));
+    SCHED_COUNT(counters.max(STAT_MAX_LIVE, live));
+}
+
+/**
+ * @brief Check that no other slot holds a PCB with this ID, printing an error if one does.
+ * Every ID maps to one slot in the index, so a second PCB with the same ID would make the first one
+ * unreachable through findByPID once either of them is removed.
+ *
+ * @param pid: the ID of the PCB about to be stored
+ * @param idx: the slot it is about to be stored in; a PCB with the same ID there is about to be replaced
+ * @return bool: true if the ID can be stored in the slot
+ */
+bool PCBTable::pidAvailable(unsigned int pid, unsigned int idx) {
+    uint32_t slot;
+    if (pids.find(pid, slot) && slot != idx) {
+        cerr << "PCBTable: PID " << pid << " is already in slot " << slot << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Build the handle of a slot from its index and current generation.
+ *
+ * @param idx: the slot
+ * @return Handle: the handle of the slot's current PCB
+ */
+PCBTable::Handle PCBTable::makeHandle(unsigned int idx) const {
+    Handle h = {((uint32_t) generations[idx] << INDEX_BITS) | idx};
+    return h;
 }
 
 /**
@@ -34,16 +140,176 @@ PCBTable::~PCBTable() {
  * @return PCB*: pointer to the PCB at index "idx"
  */
 PCB* PCBTable::getPCB(unsigned int idx) {
-    // TODO: add your code here
-    return NULL;
+    if (idx >= table.size()) {
+        return NULL;
+    }
+    return table[idx];
 }
 
 /**
  * @brief Add a PCB pointer to the PCBTable at index idx.
+ * The table takes ownership of the PCB and deletes it when the slot is cleared. If another slot holds a PCB
+ * with the same ID, nothing is changed and the PCB stays the caller's.
  *
  * @param pcb: the PCB to add
  */
 void PCBTable::addPCB(PCB *pcb, unsigned int idx) {
-    // TODO: add your code here
-    // Add a PCB pointer to the PCBTable at index idx.
+    if (idx >= table.size()) {
+        cerr << "PCBTable: index " << idx << " is out of range (capacity " << table.size() << ")" << endl;
+        return;
+    }
+    if (table[idx] == pcb) {
+        return;
+    }
+    if (pcb != NULL && !pidAvailable(pcb->getID(), idx)) {
+        return;
+    }
+    // The table owns its PCBs, so release whatever was stored in the slot before
+    if (table[idx] != NULL) {
+        clearSlot(idx);
+    }
+    if (pcb != NULL) {
+        fillSlot(idx, pcb);
+    }
+}
+
+/**
+ * @brief Add a new PCB to the PCBTable. The PCB is constructed in the table's slab, without allocating.
+ * Nothing is changed if another slot holds a PCB with the same ID.
+ * @param pid Id of the new PCB
+ * @param priority Priority of the new PCB
+ * @param idx The index of the new PCB in the PCBTable
+ */
+void PCBTable::addNewPCB(unsigned int pid, unsigned int priority, unsigned int idx) {
+    if (idx >= table.size()) {
+        cerr << "PCBTable: index " << idx << " is out of range (capacity " << table.size() << ")" << endl;
+        return;
+    }
+    if (!pidAvailable(pid, idx)) {
+        return;
+    }
+    if (table[idx] != NULL) {
+        clearSlot(idx);
+    }
+    slab[idx] = PCB(pid, priority);
+    fillSlot(idx, &slab[idx]);
+}
+
+/**
+ * @brief Create a new PCB in any free slot, in O(1).
+ * Slots that were filled by index since they were pushed are skipped; each is popped at most once per push,
+ * so the cost stays O(1) amortized.
+ *
+ * @param pid: Id of the new PCB
+ * @param priority: Priority of the new PCB
+ * @return Handle: the handle of the new PCB, or INVALID_HANDLE if the table is full or already holds a
+ * PCB with this ID
+ */
+PCBTable::Handle PCBTable::allocPCB(unsigned int pid, unsigned int priority) {
+    if (!pidAvailable(pid, INDEX_MASK)) {
+        return INVALID_HANDLE;
+    }
+    while (!freeSlots.empty()) {
+        unsigned int idx = freeSlots.back();
+        freeSlots.pop_back();
+        onFreeList[idx] = false;
+        if (table[idx] == NULL) {
+            slab[idx] = PCB(pid, priority);
+            fillSlot(idx, &slab[idx]);
+            return makeHandle(idx);
+        }
+    }
+    return INVALID_HANDLE;
+}
+
+/**
+ * @brief Remove the PCB of a handle from the table, in O(1). All handles to it become stale.
+ *
+ * @param h: the handle of the PCB
+ * @return bool: true on success, false if the handle is stale
+ */
+bool PCBTable::releasePCB(Handle h) {
+    if (getPCB(h) == NULL) {
+        return false;
+    }
+    clearSlot(indexOf(h));
+    return true;
+}
+
+/**
+ * @brief Get the PCB of a handle.
+ *
+ * @param h: the handle of the PCB
+ * @return PCB*: the PCB, or NULL if the handle is stale
+ */
+PCB* PCBTable::getPCB(Handle h) {
+    unsigned int idx = indexOf(h);
+    if (idx >= table.size() || (h.value >> INDEX_BITS) != generations[idx]) {
+        return NULL;
+    }
+    return table[idx];
+}
+
+/**
+ * @brief Get the handle of the PCB at index "idx".
+ *
+ * @param idx: the index of the PCB
+ * @return Handle: the handle of the PCB, or INVALID_HANDLE if the slot is empty
+ */
+PCBTable::Handle PCBTable::getHandle(unsigned int idx) {
+    if (idx >= table.size() || table[idx] == NULL) {
+        return INVALID_HANDLE;
+    }
+    return makeHandle(idx);
+}
+
+/**
+ * @brief Find a PCB by its process ID, in O(1).
+ *
+ * @param pid: the process ID
+ * @return PCB*: the PCB, or NULL if no PCB in the table has that ID
+ */
+PCB* PCBTable::findByPID(unsigned int pid) {
+    SCHED_COUNT(counters.add(STAT_LOOKUPS));
+    uint32_t slot;
+    if (!pids.find(pid, slot)) {
+        SCHED_COUNT(counters.add(STAT_MISSES));
+        return NULL;
+    }
+    return table[slot];
+}
+
+/**
+ * @brief Returns the number of slots in the table.
+ *
+ * @return int: the capacity of the PCBTable
+ */
+int PCBTable::capacity() {
+    return (int) table.size();
+}
+
+/**
+ * @brief Returns the number of occupied slots.
+ *
+ * @return int: the number of PCBs in the table
+ */
+int PCBTable::count() {
+    return live;
+}
+
+/**
+ * @brief Read the hot-path counters.
+ *
+ * @return PCBTableStats: the counters, all zero unless built with SCHED_STATS
+ */
+PCBTableStats PCBTable::stats() const {
+    PCBTableStats s = {};
+#ifdef SCHED_STATS
+    s.fills = counters.sum(STAT_FILLS);
+    s.releases = counters.sum(STAT_RELEASES);
+    s.pidLookups = counters.sum(STAT_LOOKUPS);
+    s.pidMisses = counters.sum(STAT_MISSES);
+    s.maxLive = counters.maximum(STAT_MAX_LIVE);
+#endif
+    return s;
 }
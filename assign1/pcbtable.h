@@ -9,17 +9,113 @@
 // Remember to add sufficient and clear comments to your code
 #pragma once
 
+#include <cstdint>
+#include <vector>
+#include "hotcounters.h"
 #include "pcb.h"
+#include "pidindex.h"
+
+/**
+ * @brief A snapshot of the hot-path counters of a PCB table, taken with stats(). All zero unless the
+ * program is built with SCHED_STATS.
+ */
+struct PCBTableStats {
+    // PCBs put into slots (addPCB, addNewPCB, allocPCB) and removed from them
+    uint64_t fills;
+    uint64_t releases;
+    // findByPID calls, and those that found no PCB
+    uint64_t pidLookups;
+    uint64_t pidMisses;
+    // The largest number of PCBs in the table at once
+    uint64_t maxLive;
+};
 
 /**
  * @brief PCTable is an array of all PCB's in the system
- * 
+ *
+ * The table owns a contiguous slab with room for one PCB per slot, so addNewPCB and allocPCB construct PCBs
+ * in place instead of allocating them one at a time. Free slots are kept on a free list, which makes
+ * allocPCB and releasePCB O(1).
+ *
+ * Slots can also be addressed through 32-bit handles that combine the slot index with a generation counter.
+ * The generation is bumped every time the slot is released, so a handle kept past releasePCB is detected
+ * instead of silently reaching the slot's next PCB.
+ *
+ * A PIDIndex maps the ID of every PCB in the table to its slot, so findByPID is O(1) however sparse the PIDs
+ * are. The ID is recorded when the PCB enters the table; changing PCB::id afterwards is not tracked.
  */
 class PCBTable {
+public:
+    /**
+     * @brief Identifies one PCB in the table. The low INDEX_BITS bits are the slot, the rest its generation.
+     */
+    struct Handle {
+        uint32_t value;
+    };
+
+    // Number of handle bits that hold the slot index. The table has at most 2^INDEX_BITS - 1 slots.
+    static const unsigned int INDEX_BITS = 22;
+
+    // Handle returned when no PCB could be allocated. Its index is never a valid slot.
+    static const Handle INVALID_HANDLE;
+
 private:
-    // TODO: add your private member variables here
-    // choose a data structure for the PCBTable. 
-    // You can use an array of PCB pointers, e.g. vector<PCB *>. 
+    static const uint32_t INDEX_MASK = ((uint32_t)1 << INDEX_BITS) - 1;
+    static const uint32_t GENERATION_MASK = ((uint32_t)1 << (32 - INDEX_BITS)) - 1;
+
+    // The PCB pointers indexed by slot. Empty slots hold NULL. A slot points either into the slab
+    // or to a heap PCB handed over with addPCB.
+    vector<PCB *> table;
+    // Backing storage for PCBs created by the table, one per slot
+    PCB *slab;
+    // Current generation of each slot, bumped whenever the slot is released or overwritten
+    vector<uint16_t> generations;
+    // Stack of slots for allocPCB. It may hold slots that addPCB/addNewPCB have filled since; allocPCB skips them.
+    vector<unsigned int> freeSlots;
+    // Whether a slot is currently on freeSlots, so that no slot is pushed twice
+    vector<bool> onFreeList;
+    // Number of occupied slots
+    int live;
+    // Maps the ID of each PCB in the table to its slot
+    PIDIndex pids;
+    // The snapshot file the slab lives in after PCBSnapshot::load, or NULL if the slab was allocated with new[]
+    void *mapping;
+    // Length of the mapping in bytes
+    size_t mappingLength;
+
+    // PCBSnapshot saves and restores the slots, generations and PID index directly
+    friend class PCBSnapshot;
+
+    // Indexes of the hot-path counters
+    enum { STAT_FILLS, STAT_RELEASES, STAT_LOOKUPS, STAT_MISSES, STAT_MAX_LIVE, STAT_COUNT };
+#ifdef SCHED_STATS
+    HotCounters<STAT_COUNT> counters;
+#endif
+
+    /**
+     * @brief Put a PCB into an empty slot and index it by its ID.
+     */
+    void fillSlot(unsigned int idx, PCB *pcb);
+
+    /**
+     * @brief Check that no other slot holds a PCB with this ID, printing an error if one does.
+     */
+    bool pidAvailable(unsigned int pid, unsigned int idx);
+
+    /**
+     * @brief Empty a slot, deleting its PCB if it is not part of the slab, and invalidate its handles.
+     */
+    void clearSlot(unsigned int idx);
+
+    /**
+     * @brief Build the handle of a slot from its index and current generation.
+     */
+    Handle makeHandle(unsigned int idx) const;
+
+    /**
+     * @brief Free the slab, whether it was allocated or mapped from a snapshot. The slots must be empty.
+     */
+    void releaseSlab();
 
 public:
     /**
@@ -35,6 +131,10 @@ public:
      */
     ~PCBTable();
 
+    // The table owns its slab and heap PCBs, so copying it is not supported
+    PCBTable(const PCBTable &) = delete;
+    PCBTable &operator=(const PCBTable &) = delete;
+
     /**
      * @brief Get the PCB at index "idx" of the PCBTable.
      *
@@ -55,6 +155,8 @@ public:
 
     /**
      * @brief Add a PCB pointer to the PCBTable at index idx.
+     * PIDs are unique within the table: if another slot holds a PCB with the same ID, nothing is changed
+     * and the PCB stays the caller's.
      *
      * @param pcb: the PCB pointer to add
      * @param idx: the index to add the PCB at
@@ -62,13 +164,86 @@ public:
     void addPCB(PCB *pcb, unsigned int idx);
 
     /**
-     * @brief Add a new PCB to the PCBTable.
+     * @brief Add a new PCB to the PCBTable. The PCB is constructed in the table's slab, without allocating.
+     * Nothing is changed if another slot holds a PCB with the same ID.
      * @param pid Id of the new PCB
      * @param priority Priority of the new PCB
      * @param idx The index of the new PCB in the PCBTable
      */
-    void addNewPCB(unsigned int pid, unsigned int priority, unsigned int idx) {
-        PCB *pcb = new PCB(pid, priority);
-        addPCB(pcb, idx);
+    void addNewPCB(unsigned int pid, unsigned int priority, unsigned int idx);
+
+    /**
+     * @brief Create a new PCB in any free slot, in O(1).
+     *
+     * @param pid: Id of the new PCB
+     * @param priority: Priority of the new PCB
+     * @return Handle: the handle of the new PCB, or INVALID_HANDLE if the table is full or already holds a
+     * PCB with this ID
+     */
+    Handle allocPCB(unsigned int pid, unsigned int priority);
+
+    /**
+     * @brief Remove the PCB of a handle from the table, in O(1). All handles to it become stale.
+     *
+     * @param h: the handle of the PCB
+     * @return bool: true on success, false if the handle is stale
+     */
+    bool releasePCB(Handle h);
+
+    /**
+     * @brief Get the PCB of a handle.
+     *
+     * @param h: the handle of the PCB
+     * @return PCB*: the PCB, or NULL if the handle is stale
+     */
+    PCB* getPCB(Handle h);
+
+    /**
+     * @brief Get the handle of the PCB at index "idx".
+     *
+     * @param idx: the index of the PCB
+     * @return Handle: the handle of the PCB, or INVALID_HANDLE if the slot is empty
+     */
+    Handle getHandle(unsigned int idx);
+
+    /**
+     * @brief Get the slot index of a handle.
+     *
+     * @param h: a handle returned by the table
+     * @return unsigned int: the slot the handle refers to
+     */
+    static unsigned int indexOf(Handle h) {
+        return h.value & INDEX_MASK;
     }
+
+    /**
+     * @brief Find a PCB by its process ID, in O(1).
+     * The table refuses a second PCB with an ID it already holds, so at most one PCB matches.
+     *
+     * @param pid: the process ID
+     * @return PCB*: the PCB, or NULL if no PCB in the table has that ID
+     */
+    PCB* findByPID(unsigned int pid);
+
+    /**
+     * @brief Returns the number of slots in the table.
+     *
+     * @return int: the capacity of the PCBTable
+     */
+    int capacity();
+
+    /**
+     * @brief Returns the number of occupied slots.
+     *
+     * @return int: the number of PCBs in the table
+     */
+    int count();
+
+    /**
+     * @brief Read the hot-path counters. Safe to call from any thread while the table is in use; the counts
+     * may lag the latest operations slightly.
+     *
+     * @return PCBTableStats: the counters, all zero unless built with SCHED_STATS
+     */
+    PCBTableStats stats() const;
 };
@@ -0,0 +1,260 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file pidindex.cpp
+ * @brief This is the implementation file for the PIDIndex class.
+ */
+#include <cstdlib>
+#include "pidindex.h"
+
+// Number of old buckets drained by each insert or erase while a resize is in progress. With a load limit of
+// 7/8 this drains the old table well before the new one can fill up.
+static const uint32_t MIGRATE_STEP = 8;
+
+/**
+ * @brief Allocate an empty table.
+ * calloc hands out large arrays as fresh zero pages from the OS, so starting a resize does not touch every
+ * bucket up front; the pages are faulted in as the migration and new inserts reach them.
+ *
+ * @param t: the table to initialize
+ * @param capacity: the number of buckets, a power of two
+ */
+void PIDIndex::initTable(Table &t, uint32_t capacity) {
+    t.entries = (Entry *) calloc(capacity, sizeof(Entry));
+    t.capacity = capacity;
+    t.size = 0;
+    t.bits = 0;
+    while (((uint32_t)1 << t.bits) < capacity) {
+        t.bits++;
+    }
+}
+
+/**
+ * @brief Home bucket of a PID. Fibonacci hashing spreads consecutive PIDs across the table.
+ *
+ * @param t: the table
+ * @param pid: the process ID
+ * @return uint32_t: the home bucket
+ */
+uint32_t PIDIndex::home(const Table &t, uint32_t pid) {
+    if (t.bits == 0) {
+        return 0;
+    }
+    return (uint32_t) (pid * 2654435769u) >> (32 - t.bits);
+}
+
+/**
+ * @brief Find the entry of a PID in one table.
+ * The probe stops at an empty bucket or at an entry closer to its home than the PID would be, since
+ * Robin Hood insertion would have placed the PID before such an entry.
+ *
+ * @param t: the table
+ * @param pid: the process ID
+ * @return Entry*: the entry, or NULL if the PID is not in the table
+ */
+PIDIndex::Entry *PIDIndex::lookup(const Table &t, uint32_t pid) {
+    if (t.entries == NULL) {
+        return NULL;
+    }
+    uint32_t mask = t.capacity - 1;
+    uint32_t pos = home(t, pid);
+    for (int32_t probe = 1;; probe++) {
+        Entry &e = t.entries[pos];
+        if (e.probe < probe) {
+            return NULL;
+        }
+        if (e.pid == pid) {
+            return &e;
+        }
+        pos = (pos + 1) & mask;
+    }
+}
+
+/**
+ * @brief Insert a PID that is not in the table. The table must have a free bucket.
+ *
+ * @param t: the table
+ * @param pid: the process ID
+ * @param value: its value
+ */
+void PIDIndex::insertInto(Table &t, uint32_t pid, uint32_t value) {
+    uint32_t mask = t.capacity - 1;
+    uint32_t pos = home(t, pid);
+    Entry cur = {pid, value, 1};
+    while (true) {
+        Entry &e = t.entries[pos];
+        if (e.probe == 0) {
+            e = cur;
+            t.size++;
+            return;
+        }
+        // Take the bucket from an entry that is closer to its home, and carry that entry on instead
+        if (e.probe < cur.probe) {
+            Entry displaced = e;
+            e = cur;
+            cur = displaced;
+        }
+        pos = (pos + 1) & mask;
+        cur.probe++;
+    }
+}
+
+/**
+ * @brief Remove the entry at a bucket, shifting the following displaced entries back by one.
+ *
+ * @param t: the table
+ * @param pos: an occupied bucket
+ */
+void PIDIndex::eraseAt(Table &t, uint32_t pos) {
+    uint32_t mask = t.capacity - 1;
+    uint32_t next = (pos + 1) & mask;
+    while (t.entries[next].probe > 1) {
+        t.entries[pos] = t.entries[next];
+        t.entries[pos].probe--;
+        pos = next;
+        next = (next + 1) & mask;
+    }
+    t.entries[pos].probe = 0;
+    t.size--;
+}
+
+/**
+ * @brief Construct a new PIDIndex object
+ *
+ * @param capacity: the initial number of buckets; rounded up to a power of two
+ */
+PIDIndex::PIDIndex(int capacity) {
+    uint32_t n = 16;
+    while (capacity > 0 && n < (uint32_t) capacity) {
+        n *= 2;
+    }
+    initTable(current, n);
+    old.entries = NULL;
+    old.capacity = 0;
+    old.size = 0;
+    old.bits = 0;
+    cursor = 0;
+}
+
+/**
+ * @brief Destructor
+ */
+PIDIndex::~PIDIndex() {
+    free(current.entries);
+    free(old.entries);
+}
+
+/**
+ * @brief Start a resize: the current table becomes the old one and a table twice its size becomes current.
+ */
+void PIDIndex::startResize() {
+    old = current;
+    initTable(current, old.capacity * 2);
+    cursor = 0;
+}
+
+/**
+ * @brief Move the entries of a few buckets of the old table into the current one.
+ * Draining bucket i shifts the rest of its cluster back into i, so the loop keeps taking from i until it is
+ * empty. Afterwards no entry of the old table has its home below the cursor, and erases only ever shift
+ * entries into buckets at or above the cursor, so the drained prefix stays empty.
+ */
+void PIDIndex::migrateStep() {
+    if (old.entries == NULL) {
+        return;
+    }
+    for (uint32_t n = 0; n < MIGRATE_STEP && cursor < old.capacity; n++, cursor++) {
+        while (old.entries[cursor].probe != 0) {
+            Entry e = old.entries[cursor];
+            eraseAt(old, cursor);
+            insertInto(current, e.pid, e.value);
+        }
+    }
+    if (cursor >= old.capacity || old.size == 0) {
+        free(old.entries);
+        old.entries = NULL;
+        old.capacity = 0;
+        old.size = 0;
+    }
+}
+
+/**
+ * @brief Drain the old table completely, so that every entry is in the current one.
+ */
+void PIDIndex::finishResize() {
+    while (old.entries != NULL) {
+        migrateStep();
+    }
+}
+
+/**
+ * @brief Map a PID to a value, replacing any previous value of the PID.
+ *
+ * @param pid: the process ID
+ * @param value: the value to store, e.g. the PCBTable slot of the process
+ */
+void PIDIndex::insert(uint32_t pid, uint32_t value) {
+    migrateStep();
+    Entry *e = lookup(current, pid);
+    if (e == NULL) {
+        e = lookup(old, pid);
+    }
+    if (e != NULL) {
+        e->value = value;
+        return;
+    }
+    if ((uint64_t) (current.size + 1) * 8 > (uint64_t) current.capacity * 7) {
+        // A resize still in progress is finished first; with MIGRATE_STEP this only happens for tiny tables
+        finishResize();
+        startResize();
+    }
+    insertInto(current, pid, value);
+}
+
+/**
+ * @brief Look up the value of a PID.
+ *
+ * @param pid: the process ID
+ * @param value: receives the value if the PID is present
+ * @return bool: true if the PID is present
+ */
+bool PIDIndex::find(uint32_t pid, uint32_t &value) const {
+    Entry *e = lookup(current, pid);
+    if (e == NULL) {
+        e = lookup(old, pid);
+    }
+    if (e == NULL) {
+        return false;
+    }
+    value = e->value;
+    return true;
+}
+
+/**
+ * @brief Remove a PID.
+ *
+ * @param pid: the process ID
+ * @return bool: true if the PID was present
+ */
+bool PIDIndex::erase(uint32_t pid) {
+    migrateStep();
+    Entry *e = lookup(current, pid);
+    if (e != NULL) {
+        eraseAt(current, (uint32_t) (e - current.entries));
+        return true;
+    }
+    e = lookup(old, pid);
+    if (e != NULL) {
+        eraseAt(old, (uint32_t) (e - old.entries));
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the number of PIDs in the index.
+ *
+ * @return int: the number of entries
+ */
+int PIDIndex::size() const {
+    return (int) (current.size + old.size);
+}
@@ -0,0 +1,123 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file pidindex.h
+ * @brief PIDIndex maps process IDs to PCBTable slots with an open-addressing hash table.
+ * @version 0.1
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief A hash map from 32-bit process IDs to 32-bit values (PCBTable slots), for O(1) lookup by PID when
+ * PIDs are sparse.
+ *
+ * Entries live in one flat array and collisions are resolved with Robin Hood linear probing: an entry that
+ * is further from its home bucket takes the place of one that is closer. This keeps probe sequences short,
+ * so a lookup usually touches a single cache line, and lets a lookup stop early on a miss. Erase shifts the
+ * following entries back instead of leaving tombstones.
+ *
+ * When the table gets 7/8 full it is not rehashed at once. A table twice the size becomes current and the
+ * old one is drained a few buckets at a time by later inserts and erases, so no single operation pays for
+ * moving every entry. Until the old table is empty, lookups check both.
+ */
+class PIDIndex {
+private:
+    // One bucket. probe is one more than the distance of the entry from its home bucket, or 0 if the bucket is
+    // empty, so a zero-filled array is an empty table.
+    struct Entry {
+        uint32_t pid;
+        uint32_t value;
+        int32_t probe;
+    };
+
+    // A flat open-addressing table. The capacity is a power of two.
+    struct Table {
+        Entry *entries;
+        uint32_t capacity;
+        uint32_t size;
+        // log2(capacity), used to map the hash to a bucket
+        unsigned int bits;
+    };
+
+    // The table that receives inserts
+    Table current;
+    // The table being drained after a resize; its entries is NULL when no resize is in progress
+    Table old;
+    // Buckets of old below this index have been drained
+    uint32_t cursor;
+
+    static void initTable(Table &t, uint32_t capacity);
+    static uint32_t home(const Table &t, uint32_t pid);
+    static Entry *lookup(const Table &t, uint32_t pid);
+    static void insertInto(Table &t, uint32_t pid, uint32_t value);
+    static void eraseAt(Table &t, uint32_t pos);
+
+    /**
+     * @brief Start a resize: the current table becomes the old one and a table twice its size becomes current.
+     */
+    void startResize();
+
+    /**
+     * @brief Move the entries of a few buckets of the old table into the current one.
+     */
+    void migrateStep();
+
+    /**
+     * @brief Drain the old table completely, so that every entry is in the current one.
+     */
+    void finishResize();
+
+    // PCBSnapshot copies the current table to and from a snapshot file
+    friend class PCBSnapshot;
+
+public:
+    /**
+     * @brief Construct a new PIDIndex object
+     *
+     * @param capacity: the initial number of buckets; rounded up to a power of two
+     */
+    PIDIndex(int capacity = 16);
+
+    /**
+     * @brief Destructor
+     */
+    ~PIDIndex();
+
+    // The index owns raw bucket arrays, so copying it is not supported
+    PIDIndex(const PIDIndex &) = delete;
+    PIDIndex &operator=(const PIDIndex &) = delete;
+
+    /**
+     * @brief Map a PID to a value, replacing any previous value of the PID. O(1) amortized and worst case,
+     * apart from the allocation of a new table when a resize starts.
+     *
+     * @param pid: the process ID
+     * @param value: the value to store, e.g. the PCBTable slot of the process
+     */
+    void insert(uint32_t pid, uint32_t value);
+
+    /**
+     * @brief Look up the value of a PID.
+     *
+     * @param pid: the process ID
+     * @param value: receives the value if the PID is present
+     * @return bool: true if the PID is present
+     */
+    bool find(uint32_t pid, uint32_t &value) const;
+
+    /**
+     * @brief Remove a PID.
+     *
+     * @param pid: the process ID
+     * @return bool: true if the PID was present
+     */
+    bool erase(uint32_t pid);
+
+    /**
+     * @brief Returns the number of PIDs in the index.
+     *
+     * @return int: the number of entries
+     */
+    int size() const;
+};
@@ -1,58 +1,10 @@
-#include <iostream>
-#include "readyqueue.h"
-
-using namespace std;
-
-//You must complete the all parts marked as "TODO". Delete "TODO" after you are done.
-// Remember to add sufficient comments to your code
-
-
-/**
- * @brief Constructor for the ReadyQueue class.
- */
- ReadyQueue::ReadyQueue()  {
-     //TODO: add your code here
- }
-
-/**
- *@brief Destructor
-*/
-ReadyQueue::~ReadyQueue() {
-    //TODO: add your code to release dynamically allocate memory
-}
-
 /**
- * @brief Add a PCB representing a process into the ready queue.
- *
- * @param pcbPtr: the pointer to the PCB to be added
+ * Assignment 1: priority queue of processes
+ * @file readyqueue.cpp
+ * @brief The ReadyQueue and AgingReadyQueue configurations of BasicReadyQueue are compiled once here. The member
+ * definitions are in readyqueue_impl.h so that other configurations can be instantiated where they are used.
  */
-void ReadyQueue::addPCB(PCB *pcbPtr) {
-    //TODO: add your code here
-    // When adding a PCB to the queue, you must change its state to READY.
-}
-
-/**
- * @brief Remove and return the PCB with the highest priority from the queue
- *
- * @return PCB*: the pointer to the PCB with the highest priority
- */
-PCB* ReadyQueue::removePCB() {
-    //TODO: add your code here
-    // When removing a PCB from the queue, you must change its state to RUNNING.
-}
-
-/**
- * @brief Returns the number of elements in the queue.
- *
- * @return int: the number of PCBs in the queue
- */
-int ReadyQueue::size() {
-    //TODO: add your code here
-}
+#include "readyqueue.h"
 
-/**
- * @brief Display the PCBs in the queue.
- */
-void ReadyQueue::displayAll() {
-    //TODO: add your code here
-}
\ No newline at end of file
+template class BasicReadyQueue<50, FifoOrder, DynamicStorage>;
+template class BasicReadyQueue<50, FifoOrder, DynamicStorage, LazyAging>;
@@ -10,28 +10,370 @@
 // Remember to add sufficient comments to your code
 #pragma once
 
+#include <cstdint>
+#include "hotcounters.h"
 #include "pcb.h"
 
+// Number of values of ProcState
+static const int NUM_PROC_STATES = 5;
+
+/**
+ * @brief A snapshot of the hot-path counters of a ready queue, taken with stats(). All zero unless the
+ * program is built with SCHED_STATS.
+ */
+struct ReadyQueueStats {
+    // PCBs added by addPCB/addPCBs, and dispatched by removePCB/removeTopK
+    uint64_t inserts;
+    uint64_t removes;
+    // PCBs taken out with erase, and moved with updatePriority
+    uint64_t erases;
+    uint64_t priorityUpdates;
+    // Aging steps run, and PCBs relabelled into the top level by them
+    uint64_t agingSteps;
+    uint64_t agedPCBs;
+    // The largest number of PCBs queued at once
+    uint64_t maxDepth;
+    // transitions[from][to]: state changes made by the queue, indexed by ProcState
+    uint64_t transitions[NUM_PROC_STATES][NUM_PROC_STATES];
+};
+
+// Ordering policies: how PCBs of equal priority are dispatched.
+
+// PCBs of equal priority are dispatched in the order they were added
+struct FifoOrder {
+    static const bool FIFO = true;
+};
+
+// The PCB added last is dispatched first among equal priorities
+struct LifoOrder {
+    static const bool FIFO = false;
+};
+
+// Aging policies: whether the queue can age. Each provides a Stamp that is part of every queue node.
+
+// No aging and no wait metric: levels map straight to buckets, and add/remove keep no dispatch clock
+struct NoAging {
+    static const bool ENABLED = false;
+    struct Stamp {};
+};
+
+// setAgingRate can turn on aging, and maxWait reports the longest wait. Each node records when it was added.
+struct LazyAging {
+    static const bool ENABLED = true;
+    struct Stamp {
+        // The dispatch clock when the PCB was added, for the wait metric
+        unsigned int enqueued;
+    };
+};
+
+// Storage policies: where the queue nodes live. Each provides a Pool<Node> with data(), capacity() and grow(),
+// where grow() returns false if the pool cannot get any bigger.
+
+/**
+ * @brief Nodes live in a heap array that doubles when it runs out. It only grows, so steady-state add/remove
+ * never allocates.
+ */
+struct DynamicStorage {
+    template <typename Node>
+    class Pool {
+    private:
+        Node *nodes;
+        int size;
+
+    public:
+        Pool() : nodes(NULL), size(0) {}
+        ~Pool() { delete[] nodes; }
+        Pool(const Pool &) = delete;
+        Pool &operator=(const Pool &) = delete;
+
+        Node *data() { return nodes; }
+        const Node *data() const { return nodes; }
+        int capacity() const { return size; }
+
+        bool grow() {
+            int newSize = (size == 0) ? 64 : size * 2;
+            Node *newNodes = new Node[newSize];
+            for (int i = 0; i < size; i++) {
+                newNodes[i] = nodes[i];
+            }
+            delete[] nodes;
+            nodes = newNodes;
+            size = newSize;
+            return true;
+        }
+    };
+};
+
+/**
+ * @brief Nodes live in an array of Capacity entries inside the queue object: no heap allocation at all, and
+ * addPCB fails once Capacity PCBs are queued.
+ */
+template <int Capacity>
+struct FixedStorage {
+    static_assert(Capacity > 0, "a fixed pool needs at least one node");
+
+    template <typename Node>
+    class Pool {
+    private:
+        Node nodes[Capacity];
+        // Number of nodes handed to the queue so far: 0 before the first grow, Capacity after it
+        int size;
+
+    public:
+        Pool() : size(0) {}
+
+        Node *data() { return nodes; }
+        const Node *data() const { return nodes; }
+        int capacity() const { return size; }
+
+        bool grow() {
+            if (size == Capacity) {
+                return false;
+            }
+            size = Capacity;
+            return true;
+        }
+    };
+};
+
 /**
  * @brief A queue of PCB's that are in the READY state to be scheduled to run.
  * It should be a priority queue such that the process with the highest priority can be selected next.
+ *
+ * Priorities are bounded (1..MaxPriority), so instead of a heap the queue keeps one bucket per priority level
+ * and an occupancy bitmap with bit p set while bucket p is non-empty. The highest non-empty level is found with
+ * a count-leading-zeros instruction (two for more than 63 levels), which makes both addPCB and removePCB O(1).
+ *
+ * The priority range, the order within a priority (Ordering: FifoOrder or LifoOrder), where the nodes live
+ * (Storage: DynamicStorage or FixedStorage<N>) and whether the queue can age (Aging: NoAging or LazyAging) are
+ * template parameters. Everything that depends on them is resolved at compile time: the bucket and bitmap arrays
+ * are sized with constants, the single-word bitmap case drops the summary word entirely, and without aging the
+ * ring indirection and the dispatch clock compile away. ReadyQueue, below, is the configuration used by the rest
+ * of the code.
+ *
+ * With LazyAging, aging (setAgingRate) bounds how long a low-priority PCB can wait: every agingRate dispatches,
+ * every queued PCB moves up one level, up to MAX_PRIORITY. Walking the queue would cost O(n) per step, so
+ * instead levels 1..MAX_PRIORITY-1 live in a ring of buckets and a step rotates the ring by one and shifts the
+ * bitmap by one bit. Level MAX_PRIORITY has a bucket of its own; the PCBs reaching it are appended to it and
+ * relabelled, which happens at most once per PCB, so aging costs O(1) amortized per operation. The PCB's own
+ * priority is not changed by aging.
  */
-class ReadyQueue {
+template <unsigned int MaxPriority, typename Ordering = FifoOrder, typename Storage = DynamicStorage,
+          typename Aging = NoAging>
+class BasicReadyQueue {
+public:
+    // The largest priority accepted by the queue. Valid priorities are 1..MAX_PRIORITY.
+    static const unsigned int MAX_PRIORITY = MaxPriority;
+
+    /**
+     * @brief Identifies one queued PCB. Returned by addPCB and accepted by updatePriority and erase.
+     * A handle becomes stale once its PCB leaves the queue, and stale handles are rejected.
+     */
+    struct Handle {
+        // Index of the node in the pool, or -1 for a handle that never referred to a node
+        int index;
+        // Generation of the node when the handle was issued
+        unsigned int generation;
+    };
+
+    // Handle returned when a PCB could not be added
+    static constexpr Handle INVALID_HANDLE = {-1, 0};
+
 private:
-    // TODO: add your private member variables here
-    // choose a data structure for the ReadyQueue. No STL class is allowed.
+    static_assert(MaxPriority >= 1, "the queue needs at least one priority level");
+
+    // Number of 64-bit bitmap words, one bit per priority level including the unused level 0
+    static const unsigned int WORDS = MaxPriority / 64 + 1;
+    static_assert(WORDS <= 64, "the summary word has one bit per bitmap word");
+
+    // A queued entry. Entries of one bucket are doubly linked through indexes into the pool (-1 ends the chain),
+    // so an entry can be unlinked in O(1) given only its index. The Stamp of the aging policy adds the time
+    // the PCB was added, or nothing.
+    struct Node : Aging::Stamp {
+        PCB *pcb;
+        int prev;
+        int next;
+        // The bucket the node is linked into, or 0 while the node is on the free list. This is a position in
+        // the bucket array, not a priority level; see levelOf.
+        unsigned int bucket;
+        // Bumped every time the node is released, so handles to an earlier use of it become stale
+        unsigned int generation;
+    };
+
+    // The queue of one priority level, as indexes of its first and last node (-1 when empty).
+    struct Bucket {
+        int head;
+        int tail;
+    };
+
+    // Number of levels that rotate when the queue ages: all but MAX_PRIORITY
+    static const unsigned int RING = MaxPriority - 1;
+
+    // One bucket per priority level. Index 0 is unused since priorities start at 1. buckets[MaxPriority] always
+    // holds level MAX_PRIORITY; buckets 1..RING form a ring holding the other levels, rotated by aging.
+    Bucket buckets[MaxPriority + 1];
+    // Bit p is set if and only if buckets[p] is non-empty
+    uint64_t bitmap[WORDS];
+    // Bit w is set if and only if bitmap[w] is non-zero. Only used when there is more than one word.
+    uint64_t summary;
+    // Node pool shared by all buckets
+    typename Storage::template Pool<Node> pool;
+    // Head of the chain of unused nodes in the pool (-1 when the pool is exhausted)
+    int freeList;
+    // Number of PCBs currently in the queue
+    int count;
+    // How far the ring has been rotated by aging, in the range 0..RING-1
+    unsigned int rotation;
+    // Dispatches between aging steps, or 0 if aging is off
+    unsigned int agingRate;
+    // Dispatches since the last aging step
+    unsigned int sinceAging;
+    // Number of PCBs dispatched so far; the unit of waiting time
+    unsigned int clock;
+    // The longest wait of a dispatched PCB since the last resetMaxWait
+    unsigned int longestWait;
+
+    // Indexes of the hot-path counters; the transition matrix takes the last NUM_PROC_STATES^2 of them
+    enum {
+        STAT_INSERTS, STAT_REMOVES, STAT_ERASES, STAT_UPDATES, STAT_AGING_STEPS, STAT_AGED, STAT_MAX_DEPTH,
+        STAT_TRANSITIONS, STAT_COUNT = STAT_TRANSITIONS + NUM_PROC_STATES * NUM_PROC_STATES
+    };
+#ifdef SCHED_STATS
+    HotCounters<STAT_COUNT> counters;
+#endif
+
+    /**
+     * @brief Count the state change the queue is about to make to a PCB.
+     */
+    void countTransition(PCB *pcb, ProcState to) {
+        SCHED_COUNT(counters.add(STAT_TRANSITIONS + (int) pcb->getState() * NUM_PROC_STATES + (int) to));
+    }
+
+    /**
+     * @brief The bucket that currently holds a priority level.
+     */
+    unsigned int bucketOf(unsigned int level) const {
+        if constexpr (!Aging::ENABLED) {
+            return level;
+        }
+        if (level == MaxPriority) {
+            return MaxPriority;
+        }
+        unsigned int b = level - 1 + rotation;
+        return (b >= RING ? b - RING : b) + 1;
+    }
+
+    /**
+     * @brief The priority level a bucket currently holds.
+     */
+    unsigned int levelOf(unsigned int bucket) const {
+        if constexpr (!Aging::ENABLED) {
+            return bucket;
+        }
+        if (bucket == MaxPriority) {
+            return MaxPriority;
+        }
+        unsigned int l = bucket - 1 + RING - rotation;
+        return (l >= RING ? l - RING : l) + 1;
+    }
+
+    /**
+     * @brief Index of the highest set bit of a non-zero word.
+     */
+    static int highestBit(uint64_t bits) {
+        return 63 - __builtin_clzll(bits);
+    }
+
+    /**
+     * @brief Mark a priority level as non-empty.
+     */
+    void setBit(unsigned int p) {
+        bitmap[p / 64] |= (uint64_t)1 << (p % 64);
+        if constexpr (WORDS > 1) {
+            summary |= (uint64_t)1 << (p / 64);
+        }
+    }
+
+    /**
+     * @brief Mark a priority level as empty.
+     */
+    void clearBit(unsigned int p) {
+        bitmap[p / 64] &= ~((uint64_t)1 << (p % 64));
+        if constexpr (WORDS > 1) {
+            if (bitmap[p / 64] == 0) {
+                summary &= ~((uint64_t)1 << (p / 64));
+            }
+        }
+    }
+
+    /**
+     * @brief Whether every priority level is empty.
+     */
+    bool isEmpty() const {
+        if constexpr (WORDS > 1) {
+            return summary == 0;
+        } else {
+            return bitmap[0] == 0;
+        }
+    }
+
+    /**
+     * @brief The highest non-empty priority level. The queue must not be empty.
+     */
+    unsigned int highestLevel() const {
+        if constexpr (WORDS > 1) {
+            int w = highestBit(summary);
+            return w * 64 + highestBit(bitmap[w]);
+        } else {
+            return highestBit(bitmap[0]);
+        }
+    }
+
+    /**
+     * @brief Grow the node pool and thread the new nodes onto the free list.
+     */
+    bool grow();
+
+    /**
+     * @brief Link node n into the bucket for the given priority, at the tail for FIFO order or the head for LIFO.
+     */
+    void link(int n, unsigned int priority);
+
+    /**
+     * @brief Unlink node n from its bucket, clearing the bucket's bitmap bit if it becomes empty.
+     */
+    void unlink(int n);
+
+    /**
+     * @brief Return node n to the free list and invalidate all handles to it.
+     */
+    void release(int n);
+
+    /**
+     * @brief Check whether a handle still refers to a queued PCB.
+     */
+    bool isLive(Handle h) const;
+
+    /**
+     * @brief Move every queued PCB up one level, in O(1) apart from relabelling PCBs that reach the top level.
+     */
+    void ageOneLevel();
+
+    /**
+     * @brief Record that PCBs were dispatched: advance the clock and run the aging steps that became due.
+     */
+    void advanceClock(unsigned int dispatches);
 
 public:
     /**
      * @brief Construct a new ReadyQueue object
      *
      */
-    ReadyQueue();
+    BasicReadyQueue();
 
-    /**
-     * @brief Destructor
-     */
-    ~ReadyQueue();
+    // The queue owns its node pool, so copying it is not supported
+    BasicReadyQueue(const BasicReadyQueue &) = delete;
+    BasicReadyQueue &operator=(const BasicReadyQueue &) = delete;
 
 	// You may add additional member functions, but don't change the definitions of the following four member functions.
 
@@ -39,13 +381,14 @@ public:
      * @brief Add a PCB representing a process into the ready queue.
      *
      * @param pcbPtr: the pointer to the PCB to be added
+     * @return Handle: a handle to the queued PCB for updatePriority/erase, or INVALID_HANDLE on error
      */
-	void addPCB(PCB* pcbPtr);
+	Handle addPCB(PCB* pcbPtr);
 
     /**
      * @brief Remove and return the PCB with the highest priority from the queue
      *
-     * @return PCB*: the pointer to the PCB with the highest priority
+     * @return PCB*: the pointer to the PCB with the highest priority, or NULL if the queue is empty
      */
 	PCB* removePCB();
 
@@ -61,4 +404,110 @@ public:
       */
 	void displayAll();
 
-};
\ No newline at end of file
+    /**
+     * @brief Change the priority of a PCB that is already in the queue, in O(1).
+     * The PCB moves to its new priority level as if it had been removed and added again.
+     * Use this instead of PCB::setPriority for queued PCBs, which would leave it in the old bucket.
+     *
+     * @param h: the handle returned by addPCB
+     * @param priority: the new priority in the range 1..MAX_PRIORITY
+     * @return bool: true on success, false if the handle is stale or the priority is out of range
+     */
+    bool updatePriority(Handle h, unsigned int priority);
+
+    /**
+     * @brief Remove a specific PCB from the queue, in O(1). Its state is left for the caller to set.
+     *
+     * @param h: the handle returned by addPCB
+     * @return PCB*: the removed PCB, or NULL if the handle is stale
+     */
+    PCB* erase(Handle h);
+
+    /**
+     * @brief Get the priority of the PCB that removePCB would return next, without removing it.
+     *
+     * @return unsigned int: the highest queued priority, or 0 if the queue is empty
+     */
+    unsigned int topPriority();
+
+    /**
+     * @brief Add a burst of PCBs at once. The node pool is grown once for the whole batch, so the cost per PCB
+     * is a few stores. Invalid PCBs are reported and skipped. No handles are returned; use addPCB for PCBs
+     * that will need updatePriority or erase.
+     *
+     * @param pcbs: the PCBs to add, in order
+     * @param n: the number of PCBs
+     * @return int: the number of PCBs added, fewer if some were invalid or a fixed pool filled up
+     */
+    int addPCBs(PCB *const *pcbs, int n);
+
+    /**
+     * @brief Remove up to k PCBs in dispatch order, as k calls to removePCB would. Runs of the same priority
+     * are unlinked from their bucket in one step.
+     *
+     * @param k: the maximum number of PCBs to remove
+     * @param out: receives the removed PCBs, highest priority first; must have room for k
+     * @return int: the number of PCBs removed, less than k if the queue ran out
+     */
+    int removeTopK(int k, PCB **out);
+
+    /**
+     * @brief Copy the queued PCBs in dispatch order, without removing them. Adding them back in this order
+     * to an empty FIFO queue rebuilds the same queue.
+     *
+     * @param out: receives the PCBs; must have room for size()
+     * @return int: the number of PCBs copied
+     */
+    int listPCBs(PCB **out);
+
+    /**
+     * @brief Turn aging on or off. With aging on, every queued PCB gains one priority level (up to MAX_PRIORITY)
+     * each time the given number of PCBs has been dispatched, so a PCB of priority p waits at most about
+     * (MAX_PRIORITY - p) * dispatches dispatches before it reaches the top level. Only a LazyAging queue can age;
+     * any other rate than 0 is refused by a NoAging queue.
+     *
+     * @param dispatches: the number of dispatches per aging step, or 0 to turn aging off (the default)
+     * @return bool: true on success, false if aging is not supported by the queue
+     */
+    bool setAgingRate(unsigned int dispatches);
+
+    /**
+     * @brief Get the aging rate.
+     *
+     * @return unsigned int: dispatches per aging step, or 0 if aging is off
+     */
+    unsigned int getAgingRate();
+
+    /**
+     * @brief The longest time a dispatched PCB spent in the queue, measured in dispatches: the number of PCBs
+     * removed by removePCB/removeTopK between its addPCB and its own removal. PCBs taken out with erase
+     * are not counted. Only a LazyAging queue keeps the dispatch clock; a NoAging queue always reports 0.
+     *
+     * @return unsigned int: the longest wait since the queue was created or resetMaxWait was called
+     */
+    unsigned int maxWait();
+
+    /**
+     * @brief Start a new measurement period for maxWait.
+     */
+    void resetMaxWait();
+
+    /**
+     * @brief Read the hot-path counters. Safe to call from any thread while the queue is in use; the counts
+     * may lag the latest operations slightly.
+     *
+     * @return ReadyQueueStats: the counters, all zero unless built with SCHED_STATS
+     */
+    ReadyQueueStats stats() const;
+};
+
+#include "readyqueue_impl.h"
+
+// The ready queue used by the assignment: priorities 1-50, FIFO within a priority, growable node pool, no aging.
+// It is instantiated once in readyqueue.cpp.
+typedef BasicReadyQueue<50, FifoOrder, DynamicStorage> ReadyQueue;
+extern template class BasicReadyQueue<50, FifoOrder, DynamicStorage>;
+
+// The same queue with aging and the wait metric, also instantiated in readyqueue.cpp
+typedef BasicReadyQueue<50, FifoOrder, DynamicStorage, LazyAging> AgingReadyQueue;
+extern template class BasicReadyQueue<50, FifoOrder, DynamicStorage, LazyAging>;
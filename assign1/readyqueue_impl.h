@@ -0,0 +1,567 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file readyqueue_impl.h
+ * @brief Member definitions of the BasicReadyQueue template. Included at the end of readyqueue.h; do not
+ * include it directly.
+ */
+#pragma once
+
+#include <iostream>
+
+/**
+ * @brief Constructor for the ReadyQueue class.
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::BasicReadyQueue() {
+    for (unsigned int p = 0; p <= MaxPriority; p++) {
+        buckets[p].head = -1;
+        buckets[p].tail = -1;
+    }
+    for (unsigned int w = 0; w < WORDS; w++) {
+        bitmap[w] = 0;
+    }
+    summary = 0;
+    freeList = -1;
+    count = 0;
+    rotation = 0;
+    agingRate = 0;
+    sinceAging = 0;
+    clock = 0;
+    longestWait = 0;
+    grow();
+}
+
+/**
+ * @brief Grow the node pool and thread the new nodes onto the free list.
+ *
+ * @return bool: true if new nodes were added, false if the storage is fixed and already fully used
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+bool BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::grow() {
+    int oldCapacity = pool.capacity();
+    if (!pool.grow()) {
+        return false;
+    }
+    int newCapacity = pool.capacity();
+    Node *nodes = pool.data();
+    // Chain the new nodes so that the lowest index is handed out first
+    for (int i = oldCapacity; i < newCapacity; i++) {
+        nodes[i].pcb = NULL;
+        nodes[i].prev = -1;
+        nodes[i].next = (i + 1 < newCapacity) ? i + 1 : freeList;
+        nodes[i].bucket = 0;
+        nodes[i].generation = 0;
+        if constexpr (Aging::ENABLED) {
+            nodes[i].enqueued = 0;
+        }
+    }
+    freeList = oldCapacity;
+    return true;
+}
+
+/**
+ * @brief Link node n into the bucket for the given priority: appended at the tail for FIFO order, pushed at
+ * the head for LIFO order. removePCB always takes the head.
+ *
+ * @param n: index of a node that is not linked into any bucket
+ * @param priority: the level to link into, in the range 1..MAX_PRIORITY
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+void BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::link(int n, unsigned int priority) {
+    Node *nodes = pool.data();
+    unsigned int bucket = bucketOf(priority);
+    Bucket &b = buckets[bucket];
+    nodes[n].bucket = bucket;
+    if constexpr (Ordering::FIFO) {
+        nodes[n].prev = b.tail;
+        nodes[n].next = -1;
+        if (b.tail < 0) {
+            b.head = n;
+        } else {
+            nodes[b.tail].next = n;
+        }
+        b.tail = n;
+    } else {
+        nodes[n].prev = -1;
+        nodes[n].next = b.head;
+        if (b.head < 0) {
+            b.tail = n;
+        } else {
+            nodes[b.head].prev = n;
+        }
+        b.head = n;
+    }
+    setBit(priority);
+}
+
+/**
+ * @brief Unlink node n from its bucket, clearing the bucket's bitmap bit if it becomes empty.
+ *
+ * @param n: index of a node linked into a bucket
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+void BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::unlink(int n) {
+    Node *nodes = pool.data();
+    Node &node = nodes[n];
+    Bucket &b = buckets[node.bucket];
+    if (node.prev < 0) {
+        b.head = node.next;
+    } else {
+        nodes[node.prev].next = node.next;
+    }
+    if (node.next < 0) {
+        b.tail = node.prev;
+    } else {
+        nodes[node.next].prev = node.prev;
+    }
+    if (b.head < 0) {
+        clearBit(levelOf(node.bucket));
+    }
+    node.prev = -1;
+    node.next = -1;
+}
+
+/**
+ * @brief Return node n to the free list and invalidate all handles to it.
+ *
+ * @param n: index of a node that has been unlinked from its bucket
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+void BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::release(int n) {
+    Node *nodes = pool.data();
+    nodes[n].pcb = NULL;
+    nodes[n].bucket = 0;
+    nodes[n].generation++;
+    nodes[n].next = freeList;
+    freeList = n;
+}
+
+/**
+ * @brief Check whether a handle still refers to a queued PCB.
+ *
+ * @param h: the handle to check
+ * @return bool: true if the node is in use and has not been released since the handle was issued
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+bool BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::isLive(Handle h) const {
+    const Node *nodes = pool.data();
+    return h.index >= 0 && h.index < pool.capacity() && nodes[h.index].bucket != 0 &&
+           nodes[h.index].generation == h.generation;
+}
+
+/**
+ * @brief Add a PCB representing a process into the ready queue.
+ *
+ * @param pcbPtr: the pointer to the PCB to be added
+ * @return Handle: a handle to the queued PCB for updatePriority/erase, or INVALID_HANDLE on error
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+typename BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::Handle
+BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::addPCB(PCB *pcbPtr) {
+    if (pcbPtr == NULL) {
+        std::cerr << "ReadyQueue: cannot add a NULL PCB" << std::endl;
+        return INVALID_HANDLE;
+    }
+    unsigned int priority = pcbPtr->getPriority();
+    if (priority < 1 || priority > MAX_PRIORITY) {
+        std::cerr << "ReadyQueue: PCB " << pcbPtr->getID() << " has priority " << priority
+                  << " outside the range 1-" << MAX_PRIORITY << std::endl;
+        return INVALID_HANDLE;
+    }
+
+    if (freeList < 0 && !grow()) {
+        std::cerr << "ReadyQueue: the queue is full" << std::endl;
+        return INVALID_HANDLE;
+    }
+    Node *nodes = pool.data();
+    int n = freeList;
+    freeList = nodes[n].next;
+    nodes[n].pcb = pcbPtr;
+    if constexpr (Aging::ENABLED) {
+        nodes[n].enqueued = clock;
+    }
+    link(n, priority);
+    count++;
+    SCHED_COUNT(counters.add(STAT_INSERTS));
+    SCHED_COUNT(counters.max(STAT_MAX_DEPTH, count));
+
+    // When adding a PCB to the queue, its state becomes READY.
+    countTransition(pcbPtr, ProcState::READY);
+    pcbPtr->setState(ProcState::READY);
+    Handle h = {n, nodes[n].generation};
+    return h;
+}
+
+/**
+ * @brief Remove and return the PCB with the highest priority from the queue
+ *
+ * @return PCB*: the pointer to the PCB with the highest priority, or NULL if the queue is empty
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+PCB* BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::removePCB() {
+    if (isEmpty()) {
+        return NULL;
+    }
+    int n = buckets[bucketOf(highestLevel())].head;
+    Node &node = pool.data()[n];
+    PCB *pcb = node.pcb;
+    if constexpr (Aging::ENABLED) {
+        if (clock - node.enqueued > longestWait) {
+            longestWait = clock - node.enqueued;
+        }
+    }
+    unlink(n);
+    release(n);
+    count--;
+    advanceClock(1);
+    SCHED_COUNT(counters.add(STAT_REMOVES));
+
+    // When removing a PCB from the queue, its state becomes RUNNING.
+    countTransition(pcb, ProcState::RUNNING);
+    pcb->setState(ProcState::RUNNING);
+    return pcb;
+}
+
+/**
+ * @brief Add a burst of PCBs at once. The node pool is grown once for the whole batch, so the cost per PCB
+ * is a few stores. Invalid PCBs are reported and skipped.
+ *
+ * @param pcbs: the PCBs to add, in order
+ * @param n: the number of PCBs
+ * @return int: the number of PCBs added, fewer if some were invalid or a fixed pool filled up
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+int BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::addPCBs(PCB *const *pcbs, int n) {
+    // Every node that is not queued is on the free list, so this guarantees n free nodes unless the pool is fixed
+    while (pool.capacity() - count < n && grow()) {
+    }
+    Node *nodes = pool.data();
+    int added = 0;
+    for (int i = 0; i < n; i++) {
+        PCB *pcb = pcbs[i];
+        if (pcb == NULL || pcb->getPriority() < 1 || pcb->getPriority() > MAX_PRIORITY) {
+            std::cerr << "ReadyQueue: skipping invalid PCB at position " << i << " of the batch" << std::endl;
+            continue;
+        }
+        if (freeList < 0) {
+            std::cerr << "ReadyQueue: the queue is full, " << n - i << " PCBs of the batch were not added" << std::endl;
+            break;
+        }
+        int node = freeList;
+        freeList = nodes[node].next;
+        nodes[node].pcb = pcb;
+        if constexpr (Aging::ENABLED) {
+            nodes[node].enqueued = clock;
+        }
+        link(node, pcb->getPriority());
+        countTransition(pcb, ProcState::READY);
+        pcb->setState(ProcState::READY);
+        added++;
+    }
+    count += added;
+    SCHED_COUNT(counters.add(STAT_INSERTS, added));
+    SCHED_COUNT(counters.max(STAT_MAX_DEPTH, count));
+    return added;
+}
+
+/**
+ * @brief Remove up to k PCBs in dispatch order, as k calls to removePCB would. Runs of the same priority
+ * are unlinked from their bucket in one step.
+ *
+ * @param k: the maximum number of PCBs to remove
+ * @param out: receives the removed PCBs, highest priority first; must have room for k
+ * @return int: the number of PCBs removed, less than k if the queue ran out
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+int BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::removeTopK(int k, PCB **out) {
+    Node *nodes = pool.data();
+    int removed = 0;
+    while (removed < k && !isEmpty()) {
+        unsigned int p = highestLevel();
+        Bucket &b = buckets[bucketOf(p)];
+        // Take nodes from the head of the bucket and fix up the bucket once at the end
+        int n = b.head;
+        while (n >= 0 && removed < k) {
+            int next = nodes[n].next;
+            if constexpr (Aging::ENABLED) {
+                // The clock has not been advanced yet for the PCBs removed before this one
+                unsigned int wait = clock + removed - nodes[n].enqueued;
+                if (wait > longestWait) {
+                    longestWait = wait;
+                }
+            }
+            out[removed++] = nodes[n].pcb;
+            countTransition(nodes[n].pcb, ProcState::RUNNING);
+            nodes[n].pcb->setState(ProcState::RUNNING);
+            release(n);
+            n = next;
+        }
+        b.head = n;
+        if (n < 0) {
+            b.tail = -1;
+            clearBit(p);
+        } else {
+            nodes[n].prev = -1;
+        }
+    }
+    count -= removed;
+    SCHED_COUNT(counters.add(STAT_REMOVES, removed));
+    // Aging only ever raises levels in order and appends at the top, which never changes which PCB is at the
+    // head of the highest bucket, so the aging steps due during the batch can be run after it.
+    advanceClock(removed);
+    return removed;
+}
+
+/**
+ * @brief Copy the queued PCBs in dispatch order, without removing them.
+ *
+ * @param out: receives the PCBs; must have room for size()
+ * @return int: the number of PCBs copied
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+int BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::listPCBs(PCB **out) {
+    Node *nodes = pool.data();
+    int n = 0;
+    for (unsigned int p = MaxPriority; p >= 1; p--) {
+        for (int i = buckets[bucketOf(p)].head; i >= 0; i = nodes[i].next) {
+            out[n++] = nodes[i].pcb;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Change the priority of a PCB that is already in the queue, in O(1).
+ * The PCB moves to its new priority level, as if it had been removed and added again.
+ *
+ * @param h: the handle returned by addPCB
+ * @param priority: the new priority in the range 1..MAX_PRIORITY
+ * @return bool: true on success, false if the handle is stale or the priority is out of range
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+bool BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::updatePriority(Handle h, unsigned int priority) {
+    if (!isLive(h)) {
+        return false;
+    }
+    if (priority < 1 || priority > MAX_PRIORITY) {
+        std::cerr << "ReadyQueue: priority " << priority << " is outside the range 1-" << MAX_PRIORITY << std::endl;
+        return false;
+    }
+    unlink(h.index);
+    link(h.index, priority);
+    pool.data()[h.index].pcb->setPriority(priority);
+    SCHED_COUNT(counters.add(STAT_UPDATES));
+    return true;
+}
+
+/**
+ * @brief Remove a specific PCB from the queue, in O(1). Its state is left for the caller to set.
+ *
+ * @param h: the handle returned by addPCB
+ * @return PCB*: the removed PCB, or NULL if the handle is stale
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+PCB* BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::erase(Handle h) {
+    if (!isLive(h)) {
+        return NULL;
+    }
+    PCB *pcb = pool.data()[h.index].pcb;
+    unlink(h.index);
+    release(h.index);
+    count--;
+    SCHED_COUNT(counters.add(STAT_ERASES));
+    return pcb;
+}
+
+/**
+ * @brief Get the priority of the PCB that removePCB would return next, without removing it.
+ *
+ * @return unsigned int: the highest queued priority, or 0 if the queue is empty
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+unsigned int BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::topPriority() {
+    if (isEmpty()) {
+        return 0;
+    }
+    return highestLevel();
+}
+
+/**
+ * @brief Returns the number of elements in the queue.
+ *
+ * @return int: the number of PCBs in the queue
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+int BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::size() {
+    return count;
+}
+
+/**
+ * @brief Display the PCBs in the queue.
+ * PCBs are listed in dispatch order: highest priority first, then in bucket order.
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+void BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::displayAll() {
+    std::cout << "Display Processes in ReadyQueue:" << std::endl;
+    Node *nodes = pool.data();
+    for (unsigned int p = MaxPriority; p >= 1; p--) {
+        for (int n = buckets[bucketOf(p)].head; n >= 0; n = nodes[n].next) {
+            std::cout << "\t";
+            nodes[n].pcb->display();
+        }
+    }
+}
+
+/**
+ * @brief Move every queued PCB up one level. Level MAX_PRIORITY-1 is appended to level MAX_PRIORITY, which
+ * keeps dispatch order: the PCBs already at the top still come first. The bucket it leaves empty becomes
+ * level 1 when the ring rotates, and the bitmap shifts up by one bit with the top bit kept.
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+void BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::ageOneLevel() {
+    if constexpr (MaxPriority > 1 && Aging::ENABLED) {
+        Node *nodes = pool.data();
+        Bucket &from = buckets[bucketOf(MaxPriority - 1)];
+        if (from.head >= 0) {
+            // The only per-PCB work of aging: each PCB reaches the top level at most once while it is queued
+            for (int n = from.head; n >= 0; n = nodes[n].next) {
+                nodes[n].bucket = MaxPriority;
+                SCHED_COUNT(counters.add(STAT_AGED));
+            }
+            Bucket &top = buckets[MaxPriority];
+            if (top.head < 0) {
+                top.head = from.head;
+            } else {
+                nodes[top.tail].next = from.head;
+                nodes[from.head].prev = top.tail;
+            }
+            top.tail = from.tail;
+            from.head = -1;
+            from.tail = -1;
+        }
+        rotation = (rotation == 0) ? RING - 1 : rotation - 1;
+        SCHED_COUNT(counters.add(STAT_AGING_STEPS));
+
+        bool topSet = (bitmap[MaxPriority / 64] >> (MaxPriority % 64)) & 1;
+        for (unsigned int w = WORDS - 1; w > 0; w--) {
+            bitmap[w] = (bitmap[w] << 1) | (bitmap[w - 1] >> 63);
+        }
+        bitmap[0] <<= 1;
+        // The old top bit moved one past MAX_PRIORITY; put it back where it was
+        if constexpr ((MaxPriority + 1) % 64 != 0) {
+            bitmap[(MaxPriority + 1) / 64] &= ~((uint64_t)1 << ((MaxPriority + 1) % 64));
+        }
+        if (topSet) {
+            bitmap[MaxPriority / 64] |= (uint64_t)1 << (MaxPriority % 64);
+        }
+        if constexpr (WORDS > 1) {
+            summary = 0;
+            for (unsigned int w = 0; w < WORDS; w++) {
+                if (bitmap[w] != 0) {
+                    summary |= (uint64_t)1 << w;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Record that PCBs were dispatched: advance the clock and run the aging steps that became due. Does
+ * nothing without aging.
+ *
+ * @param dispatches: the number of PCBs just dispatched
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+void BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::advanceClock(unsigned int dispatches) {
+    if constexpr (!Aging::ENABLED) {
+        return;
+    }
+    clock += dispatches;
+    if (agingRate == 0) {
+        return;
+    }
+    sinceAging += dispatches;
+    if (sinceAging < agingRate) {
+        return;
+    }
+    unsigned int steps = sinceAging / agingRate;
+    sinceAging %= agingRate;
+    // Nothing is added during a batch, so after MAX_PRIORITY-1 steps every PCB is at the top and more steps
+    // change nothing
+    if (steps > MaxPriority) {
+        steps = MaxPriority;
+    }
+    while (steps-- > 0) {
+        ageOneLevel();
+    }
+}
+
+/**
+ * @brief Turn aging on or off.
+ *
+ * @param dispatches: the number of dispatches per aging step, or 0 to turn aging off
+ * @return bool: true on success, false if aging is not supported by the queue
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+bool BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::setAgingRate(unsigned int dispatches) {
+    if (!Aging::ENABLED && dispatches != 0) {
+        std::cerr << "ReadyQueue: aging needs a queue built with the LazyAging policy" << std::endl;
+        return false;
+    }
+    agingRate = dispatches;
+    sinceAging = 0;
+    return true;
+}
+
+/**
+ * @brief Get the aging rate.
+ *
+ * @return unsigned int: dispatches per aging step, or 0 if aging is off
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+unsigned int BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::getAgingRate() {
+    return agingRate;
+}
+
+/**
+ * @brief The longest time a dispatched PCB spent in the queue, measured in dispatches.
+ *
+ * @return unsigned int: the longest wait since the queue was created or resetMaxWait was called
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+unsigned int BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::maxWait() {
+    return longestWait;
+}
+
+/**
+ * @brief Start a new measurement period for maxWait.
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+void BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::resetMaxWait() {
+    longestWait = 0;
+}
+
+/**
+ * @brief Read the hot-path counters.
+ *
+ * @return ReadyQueueStats: the counters, all zero unless built with SCHED_STATS
+ */
+template <unsigned int MaxPriority, typename Ordering, typename Storage, typename Aging>
+ReadyQueueStats BasicReadyQueue<MaxPriority, Ordering, Storage, Aging>::stats() const {
+    ReadyQueueStats s = {};
+#ifdef SCHED_STATS
+    s.inserts = counters.sum(STAT_INSERTS);
+    s.removes = counters.sum(STAT_REMOVES);
+    s.erases = counters.sum(STAT_ERASES);
+    s.priorityUpdates = counters.sum(STAT_UPDATES);
+    s.agingSteps = counters.sum(STAT_AGING_STEPS);
+    s.agedPCBs = counters.sum(STAT_AGED);
+    s.maxDepth = counters.maximum(STAT_MAX_DEPTH);
+    for (int from = 0; from < NUM_PROC_STATES; from++) {
+        for (int to = 0; to < NUM_PROC_STATES; to++) {
+            s.transitions[from][to] = counters.sum(STAT_TRANSITIONS + from * NUM_PROC_STATES + to);
+        }
+    }
+#endif
+    return s;
+}
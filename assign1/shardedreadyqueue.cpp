@@ -0,0 +1,227 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file shardedreadyqueue.cpp
+ * @brief This is the implementation file for the ShardedReadyQueue class.
+ */
+#include <iostream>
+#include "shardedreadyqueue.h"
+
+using namespace std;
+
+/**
+ * @brief Construct a new ShardedReadyQueue object
+ *
+ * @param numShards: the number of shards, normally one per worker thread (at least 1)
+ * @param tolerance: the allowed priority inversion between shards, in priority levels
+ */
+ShardedReadyQueue::ShardedReadyQueue(int numShards, unsigned int tolerance) {
+    if (numShards < 1) {
+        cerr << "ShardedReadyQueue: invalid number of shards " << numShards << ", using 1" << endl;
+        numShards = 1;
+    }
+    this->numShards = numShards;
+    this->tolerance = tolerance;
+    shards = new Shard[numShards];
+    for (int i = 0; i < numShards; i++) {
+        pthread_mutex_init(&shards[i].lock, NULL);
+        shards[i].top = 0;
+        shards[i].count = 0;
+    }
+}
+
+/**
+ * @brief Destructor
+ */
+ShardedReadyQueue::~ShardedReadyQueue() {
+    for (int i = 0; i < numShards; i++) {
+        pthread_mutex_destroy(&shards[i].lock);
+    }
+    delete[] shards;
+}
+
+/**
+ * @brief Add a PCB to the shard of the given worker. Thread-safe.
+ *
+ * @param pcbPtr: the pointer to the PCB to be added
+ * @param shard: the worker's shard, in the range 0..getNumShards()-1
+ * @return bool: true on success, false if the PCB or the shard is invalid
+ */
+bool ShardedReadyQueue::addPCB(PCB *pcbPtr, int shard) {
+    if (shard < 0 || shard >= numShards) {
+        cerr << "ShardedReadyQueue: shard " << shard << " is out of range (" << numShards << " shards)" << endl;
+        return false;
+    }
+    Shard &s = shards[shard];
+    pthread_mutex_lock(&s.lock);
+    bool added = s.queue.addPCB(pcbPtr).index >= 0;
+    s.top.store(s.queue.topPriority(), memory_order_relaxed);
+    s.count.store(s.queue.size(), memory_order_relaxed);
+    pthread_mutex_unlock(&s.lock);
+    return added;
+}
+
+/**
+ * @brief Choose the shard a worker should remove from next.
+ * The published tops and counts are read without locking, so the choice may be slightly out of date;
+ * removeFrom copes with a victim that has been emptied in the meantime.
+ *
+ * @param home: the worker's own shard
+ * @return int: the shard to remove from, or -1 if every shard is empty
+ */
+int ShardedReadyQueue::pickVictim(int home) {
+    // Shard holding the globally best PCB
+    int best = -1;
+    unsigned int bestTop = 0;
+    for (int i = 0; i < numShards; i++) {
+        unsigned int top = shards[i].top.load(memory_order_relaxed);
+        if (top > bestTop) {
+            bestTop = top;
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return -1;
+    }
+
+    unsigned int homeTop = shards[home].top.load(memory_order_relaxed);
+    if (homeTop != 0) {
+        // Stay local unless that would invert priorities by more than the tolerance
+        return (homeTop + tolerance >= bestTop) ? home : best;
+    }
+
+    // The worker is idle: steal from the busiest shard whose best PCB is within the tolerance
+    int busiest = best;
+    int busiestCount = shards[best].count.load(memory_order_relaxed);
+    for (int i = 0; i < numShards; i++) {
+        unsigned int top = shards[i].top.load(memory_order_relaxed);
+        int count = shards[i].count.load(memory_order_relaxed);
+        if (top != 0 && top + tolerance >= bestTop && count > busiestCount) {
+            busiest = i;
+            busiestCount = count;
+        }
+    }
+    return busiest;
+}
+
+/**
+ * @brief Remove the highest priority PCB of one shard and republish its top priority and size.
+ *
+ * @param s: the shard to remove from
+ * @return PCB*: the removed PCB, or NULL if the shard was emptied by another worker in the meantime
+ */
+PCB* ShardedReadyQueue::removeFrom(int s) {
+    Shard &shard = shards[s];
+    pthread_mutex_lock(&shard.lock);
+    PCB *pcb = shard.queue.removePCB();
+    shard.top.store(shard.queue.topPriority(), memory_order_relaxed);
+    shard.count.store(shard.queue.size(), memory_order_relaxed);
+    pthread_mutex_unlock(&shard.lock);
+    return pcb;
+}
+
+/**
+ * @brief Remove a PCB for the given worker, stealing from another shard if needed. Thread-safe.
+ *
+ * @param shard: the worker's shard, in the range 0..getNumShards()-1
+ * @return PCB*: the removed PCB, or NULL if all shards are empty
+ */
+PCB* ShardedReadyQueue::removePCB(int shard) {
+    if (shard < 0 || shard >= numShards) {
+        cerr << "ShardedReadyQueue: shard " << shard << " is out of range (" << numShards << " shards)" << endl;
+        return NULL;
+    }
+    // Retry when another worker empties the chosen shard between pickVictim and removeFrom
+    while (true) {
+        int victim = pickVictim(shard);
+        if (victim < 0) {
+            return NULL;
+        }
+        PCB *pcb = removeFrom(victim);
+        if (pcb != NULL) {
+            return pcb;
+        }
+    }
+}
+
+/**
+ * @brief Add a burst of PCBs to the shard of the given worker, taking its lock once. Thread-safe.
+ *
+ * @param pcbs: the PCBs to add, in order
+ * @param n: the number of PCBs
+ * @param shard: the worker's shard, in the range 0..getNumShards()-1
+ * @return int: the number of PCBs added
+ */
+int ShardedReadyQueue::addPCBs(PCB *const *pcbs, int n, int shard) {
+    if (shard < 0 || shard >= numShards) {
+        cerr << "ShardedReadyQueue: shard " << shard << " is out of range (" << numShards << " shards)" << endl;
+        return 0;
+    }
+    Shard &s = shards[shard];
+    pthread_mutex_lock(&s.lock);
+    int added = s.queue.addPCBs(pcbs, n);
+    s.top.store(s.queue.topPriority(), memory_order_relaxed);
+    s.count.store(s.queue.size(), memory_order_relaxed);
+    pthread_mutex_unlock(&s.lock);
+    return added;
+}
+
+/**
+ * @brief Remove up to k PCBs for the given worker, taking one lock per shard visited. Thread-safe.
+ *
+ * @param k: the maximum number of PCBs to remove
+ * @param out: receives the removed PCBs; must have room for k
+ * @param shard: the worker's shard, in the range 0..getNumShards()-1
+ * @return int: the number of PCBs removed, less than k if all shards ran out
+ */
+int ShardedReadyQueue::removeTopK(int k, PCB **out, int shard) {
+    if (shard < 0 || shard >= numShards) {
+        cerr << "ShardedReadyQueue: shard " << shard << " is out of range (" << numShards << " shards)" << endl;
+        return 0;
+    }
+    int removed = 0;
+    while (removed < k) {
+        int victim = pickVictim(shard);
+        if (victim < 0) {
+            break;
+        }
+        Shard &s = shards[victim];
+        pthread_mutex_lock(&s.lock);
+        removed += s.queue.removeTopK(k - removed, out + removed);
+        s.top.store(s.queue.topPriority(), memory_order_relaxed);
+        s.count.store(s.queue.size(), memory_order_relaxed);
+        pthread_mutex_unlock(&s.lock);
+    }
+    return removed;
+}
+
+/**
+ * @brief Returns the number of PCBs in all shards. Exact only while no worker is modifying the queue.
+ *
+ * @return int: the number of PCBs in the queue
+ */
+int ShardedReadyQueue::size() {
+    int total = 0;
+    for (int i = 0; i < numShards; i++) {
+        total += shards[i].count.load(memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @brief Returns the number of shards.
+ *
+ * @return int: the number of shards
+ */
+int ShardedReadyQueue::getNumShards() {
+    return numShards;
+}
+
+/**
+ * @brief Display the PCBs of every shard. Not thread-safe; call it while the workers are stopped.
+ */
+void ShardedReadyQueue::displayAll() {
+    for (int i = 0; i < numShards; i++) {
+        cout << "Shard " << i << ": ";
+        shards[i].queue.displayAll();
+    }
+}
@@ -0,0 +1,137 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file shardedreadyqueue.h
+ * @brief ShardedReadyQueue splits the ready queue into one ReadyQueue per dispatcher thread, so that
+ * threads do not serialize on a single lock.
+ * @version 0.1
+ */
+#pragma once
+
+#include <atomic>
+#include <pthread.h>
+#include "readyqueue.h"
+
+/**
+ * @brief A ready queue shared by several dispatcher threads.
+ *
+ * Each worker thread owns one shard, a ReadyQueue guarded by its own mutex. A worker normally adds to and
+ * removes from its own shard, so workers only contend when they steal. Every shard publishes its highest
+ * queued priority and its size in atomics that other workers read without locking:
+ *  - a worker whose own shard is empty steals from the busiest shard;
+ *  - a worker whose best PCB is more than "tolerance" levels below the best PCB in any shard takes from
+ *    that shard instead, which keeps the global dispatch order within the tolerance.
+ * A tolerance of 0 gives strict priority order (up to concurrent updates); MAX_PRIORITY disables the check,
+ * so a worker only leaves its shard when it runs out of work.
+ */
+class ShardedReadyQueue {
+private:
+    // One shard per worker. Aligned to a cache line so that workers updating neighbouring shards
+    // do not invalidate each other's lock and counters.
+    struct alignas(64) Shard {
+        pthread_mutex_t lock;
+        ReadyQueue queue;
+        // Highest priority queued in this shard, or 0 when it is empty. Written under lock, read without it.
+        std::atomic<unsigned int> top;
+        // Number of PCBs in this shard. Written under lock, read without it.
+        std::atomic<int> count;
+    };
+
+    // The shards, indexed by worker
+    Shard *shards;
+    // Number of shards
+    int numShards;
+    // How many priority levels a worker's own best PCB may lag behind the global best before it steals
+    unsigned int tolerance;
+
+    /**
+     * @brief Choose the shard a worker should remove from next.
+     *
+     * @param home: the worker's own shard
+     * @return int: the shard to remove from, or -1 if every shard is empty
+     */
+    int pickVictim(int home);
+
+    /**
+     * @brief Remove the highest priority PCB of one shard and republish its top priority and size.
+     *
+     * @param s: the shard to remove from
+     * @return PCB*: the removed PCB, or NULL if the shard was emptied by another worker in the meantime
+     */
+    PCB* removeFrom(int s);
+
+public:
+    /**
+     * @brief Construct a new ShardedReadyQueue object
+     *
+     * @param numShards: the number of shards, normally one per worker thread (at least 1)
+     * @param tolerance: the allowed priority inversion between shards, in priority levels
+     */
+    ShardedReadyQueue(int numShards, unsigned int tolerance = 0);
+
+    /**
+     * @brief Destructor
+     */
+    ~ShardedReadyQueue();
+
+    // The shards own mutexes and node pools, so copying is not supported
+    ShardedReadyQueue(const ShardedReadyQueue &) = delete;
+    ShardedReadyQueue &operator=(const ShardedReadyQueue &) = delete;
+
+    /**
+     * @brief Add a PCB to the shard of the given worker. Thread-safe.
+     *
+     * @param pcbPtr: the pointer to the PCB to be added
+     * @param shard: the worker's shard, in the range 0..getNumShards()-1
+     * @return bool: true on success, false if the PCB or the shard is invalid
+     */
+    bool addPCB(PCB *pcbPtr, int shard);
+
+    /**
+     * @brief Remove a PCB for the given worker, stealing from another shard if needed. Thread-safe.
+     *
+     * @param shard: the worker's shard, in the range 0..getNumShards()-1
+     * @return PCB*: the removed PCB, or NULL if all shards are empty
+     */
+    PCB* removePCB(int shard);
+
+    /**
+     * @brief Add a burst of PCBs to the shard of the given worker, taking its lock once. Thread-safe.
+     *
+     * @param pcbs: the PCBs to add, in order
+     * @param n: the number of PCBs
+     * @param shard: the worker's shard, in the range 0..getNumShards()-1
+     * @return int: the number of PCBs added
+     */
+    int addPCBs(PCB *const *pcbs, int n, int shard);
+
+    /**
+     * @brief Remove up to k PCBs for the given worker, taking one lock per shard visited. Thread-safe.
+     * The victim shard is chosen as in removePCB and drained in priority order; the tolerance is only
+     * rechecked when that shard runs out, so one batch may invert priorities more than single removes would.
+     *
+     * @param k: the maximum number of PCBs to remove
+     * @param out: receives the removed PCBs; must have room for k
+     * @param shard: the worker's shard, in the range 0..getNumShards()-1
+     * @return int: the number of PCBs removed, less than k if all shards ran out
+     */
+    int removeTopK(int k, PCB **out, int shard);
+
+    /**
+     * @brief Returns the number of PCBs in all shards. Exact only while no worker is modifying the queue.
+     *
+     * @return int: the number of PCBs in the queue
+     */
+    int size();
+
+    /**
+     * @brief Returns the number of shards.
+     *
+     * @return int: the number of shards
+     */
+    int getNumShards();
+
+    /**
+     * @brief Display the PCBs of every shard. Not thread-safe; call it while the workers are stopped.
+     */
+    void displayAll();
+};
@@ -0,0 +1,173 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test10.cpp
+ * @brief This file tests priority aging in the ready queue. It checks the dispatch order against a simple
+ * model that ages by moving every level, then runs the test2 workload with several aging rates and prints
+ * the longest wait of a dispatched process.
+ * Usage: ./test10 [operations]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <vector>
+#include "readyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+/**
+ * @brief Reference queue: one deque per level, and an aging step that moves every level up by one.
+ */
+class ModelQueue {
+private:
+    unsigned int maxPriority;
+    bool fifo;
+    unsigned int rate;
+    unsigned int since;
+    vector<deque<PCB *> > levels;
+
+    void age() {
+        deque<PCB *> &top = levels[maxPriority];
+        top.insert(top.end(), levels[maxPriority - 1].begin(), levels[maxPriority - 1].end());
+        for (unsigned int l = maxPriority - 1; l > 1; l--) {
+            levels[l] = levels[l - 1];
+        }
+        levels[1].clear();
+    }
+
+public:
+    ModelQueue(unsigned int maxPriority, bool fifo, unsigned int rate)
+        : maxPriority(maxPriority), fifo(fifo), rate(rate), since(0), levels(maxPriority + 1) {}
+
+    void addPCB(PCB *pcb) {
+        if (fifo) {
+            levels[pcb->getPriority()].push_back(pcb);
+        } else {
+            levels[pcb->getPriority()].push_front(pcb);
+        }
+    }
+
+    PCB *removePCB() {
+        for (unsigned int l = maxPriority; l >= 1; l--) {
+            if (!levels[l].empty()) {
+                PCB *pcb = levels[l].front();
+                levels[l].pop_front();
+                if (rate != 0 && ++since == rate) {
+                    since = 0;
+                    age();
+                }
+                return pcb;
+            }
+        }
+        return NULL;
+    }
+};
+
+/**
+ * @brief Run random adds, removes and batch removes on a queue with aging and on the model, and check that
+ * they dispatch the same PCBs in the same order.
+ *
+ * @return bool: true if the dispatch orders match
+ */
+template <typename Queue>
+bool check_order(bool fifo, unsigned int rate, int operations) {
+    const unsigned int maxPriority = Queue::MAX_PRIORITY;
+    const int size = 300;
+    PCBTable table(size);
+    Queue *queue = new Queue();
+    ModelQueue model(maxPriority, fifo, rate);
+    queue->setAgingRate(rate);
+    for (int i = 0; i < size; i++) {
+        table.addNewPCB(i + 1, 1, i);
+    }
+    srand(rate);
+    bool ok = true;
+    PCB *batch[16];
+    for (int i = 0; i < operations && ok; i++) {
+        int x = rand() % 8;
+        if (x < 4) {
+            PCB *pcb = table.getPCB(rand() % size);
+            if (pcb->getState() != ProcState::READY) {
+                pcb->setPriority(rand() % maxPriority + 1);
+                queue->addPCB(pcb);
+                model.addPCB(pcb);
+            }
+        } else if (x < 7) {
+            ok = queue->removePCB() == model.removePCB();
+        } else {
+            int k = rand() % 16 + 1;
+            int n = queue->removeTopK(k, batch);
+            for (int j = 0; j < n && ok; j++) {
+                ok = batch[j] == model.removePCB();
+            }
+            ok = ok && (n == k || model.removePCB() == NULL);
+        }
+    }
+    delete queue;
+    return ok;
+}
+
+/**
+ * @brief Run the test2 workload with an aging rate.
+ *
+ * @param rate: dispatches per aging step, 0 for no aging
+ * @param operations: the number of operations
+ */
+static void run_workload(unsigned int rate, int operations) {
+    const int size = 500;
+    srand(1);
+    AgingReadyQueue queue;
+    PCBTable table(size);
+    queue.setAgingRate(rate);
+    for (int i = 0; i < size; i++) {
+        table.addNewPCB(i + 1, rand() % 50 + 1, i);
+        if (rand() % 2 == 0) queue.addPCB(table.getPCB(i));
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < operations; i++) {
+        int x = rand();
+        if (x % 2 == 0) {
+            queue.removePCB();
+        } else {
+            PCB *pcb = table.getPCB(rand() % size);
+            if (pcb->getState() != ProcState::READY) {
+                pcb->setPriority(rand() % 50 + 1);
+                queue.addPCB(pcb);
+            }
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> runtime = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+    cout << "Aging rate " << rate << ": time taken " << runtime.count() << " seconds, max wait "
+         << queue.maxWait() << " dispatches, final size " << queue.size() << endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 10********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    int operations = (argc > 1) ? atoi(argv[1]) : 1000000;
+    if (operations <= 0) {
+        cerr << "Usage: " << argv[0] << " [operations]" << endl;
+        return 1;
+    }
+
+    bool ok = true;
+    unsigned int rates[] = {1, 3, 7, 50};
+    for (unsigned int rate : rates) {
+        ok = check_order<AgingReadyQueue>(true, rate, 200000) && ok;
+        ok = check_order<BasicReadyQueue<130, FifoOrder, DynamicStorage, LazyAging> >(true, rate, 200000) && ok;
+        ok = check_order<BasicReadyQueue<63, LifoOrder, FixedStorage<512>, LazyAging> >(false, rate, 200000) && ok;
+    }
+    cout << (ok ? "Dispatch order with aging matches the model" : "ERROR: dispatch order with aging differs") << endl;
+
+    unsigned int workloadRates[] = {0, 1000, 100, 10};
+    for (unsigned int rate : workloadRates) {
+        run_workload(rate, operations);
+    }
+    return ok ? 0 : 1;
+}
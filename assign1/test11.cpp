@@ -0,0 +1,179 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test11.cpp
+ * @brief This file tests the TimingWheel: random timers, cancels and clock jumps are checked against the
+ * expected expiry times, then adding, cancelling and expiring hundreds of thousands of timers is timed
+ * against a std::multimap ordered by expiry.
+ * Usage: ./test11 [timers]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+#include "timingwheel.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+/**
+ * @brief Seconds elapsed since t1.
+ */
+static double since(std::chrono::high_resolution_clock::time_point t1) {
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
+}
+
+/**
+ * @brief Add, cancel and advance at random, including delays beyond the range of the wheel, and check that
+ * every process expires exactly on its tick and that expiries reach the queue in tick order.
+ *
+ * @return bool: true if the wheel behaved as expected
+ */
+static bool check_expiry(int operations) {
+    const int size = 2000;
+    PCBTable table(size);
+    ReadyQueue queue;
+    TimingWheel wheel(16, 123456789);
+    vector<TimingWheel::Handle> handles(size, TimingWheel::INVALID_HANDLE);
+    // The tick each process is due, or 0 if it has no timer
+    vector<uint64_t> due(size, 0);
+    for (int i = 0; i < size; i++) {
+        // One priority, so the queue keeps the order in which expired processes are added
+        table.addNewPCB(i + 1, 1, i);
+    }
+    srand(7);
+    int pending = 0;
+    for (int op = 0; op < operations; op++) {
+        int i = rand() % size;
+        int x = rand() % 10;
+        if (x < 5 && due[i] == 0) {
+            // Mostly short timeouts, some spanning the upper levels and a few beyond the whole wheel
+            uint64_t delay = (x < 3) ? rand() % 200 : (x < 4) ? rand() % 300000 : (uint64_t) rand() * 16;
+            handles[i] = wheel.addTimer(table.getPCB(i), delay);
+            due[i] = wheel.getTime() + (delay == 0 ? 1 : delay);
+            pending++;
+        } else if (x < 7 && due[i] != 0) {
+            if (wheel.cancel(handles[i]) != table.getPCB(i) || wheel.cancel(handles[i]) != NULL) {
+                return false;
+            }
+            due[i] = 0;
+            pending--;
+        } else if (x == 9) {
+            uint64_t ticks = (rand() % 4 == 0) ? (uint64_t) rand() * 64 : rand() % 500;
+            uint64_t start = wheel.getTime();
+            int moved = wheel.advance(ticks, queue);
+            int expected = 0;
+            for (int j = 0; j < size; j++) {
+                if (due[j] != 0 && due[j] <= start + ticks) {
+                    expected++;
+                }
+            }
+            if (moved != expected || queue.size() != moved || wheel.getTime() != start + ticks) {
+                return false;
+            }
+            uint64_t last = 0;
+            while (queue.size() > 0) {
+                int j = queue.removePCB()->getID() - 1;
+                if (due[j] <= start || due[j] > start + ticks || due[j] < last) {
+                    return false;
+                }
+                last = due[j];
+                due[j] = 0;
+            }
+            pending -= moved;
+        }
+        if (wheel.size() != pending) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 11********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    int size = (argc > 1) ? atoi(argv[1]) : 500000;
+    if (size <= 0) {
+        cerr << "Usage: " << argv[0] << " [timers]" << endl;
+        return 1;
+    }
+    bool ok = check_expiry(200000);
+    cout << (ok ? "Timers expire on their tick and in order" : "ERROR: timers expired at the wrong time") << endl;
+
+    // Each process sleeps for a random timeout of up to a million ticks
+    const uint64_t maxDelay = 1000000;
+    PCBTable table(size);
+    vector<uint64_t> delays(size);
+    srand(1);
+    for (int i = 0; i < size; i++) {
+        table.addNewPCB(i + 1, rand() % 50 + 1, i);
+        delays[i] = (uint64_t) rand() % maxDelay + 1;
+    }
+    cout << size << " timers with timeouts of up to " << maxDelay << " ticks" << endl;
+
+    // Timing wheel: add all, cancel every other one, then run the clock until all the rest have expired
+    TimingWheel wheel(size);
+    ReadyQueue queue;
+    vector<TimingWheel::Handle> handles(size);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < size; i++) {
+        handles[i] = wheel.addTimer(table.getPCB(i), delays[i]);
+    }
+    double wheelAdd = since(t1);
+    t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < size; i += 2) {
+        wheel.cancel(handles[i]);
+    }
+    double wheelCancel = since(t1);
+    t1 = std::chrono::high_resolution_clock::now();
+    int wheelExpired = 0;
+    for (uint64_t t = 0; t < maxDelay; t++) {
+        wheelExpired += wheel.advance(1, queue);
+    }
+    double wheelExpire = since(t1);
+
+    // Sorted structure: a multimap ordered by expiry, with iterators kept for cancel
+    multimap<uint64_t, PCB *> sorted;
+    vector<multimap<uint64_t, PCB *>::iterator> iters(size);
+    t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < size; i++) {
+        iters[i] = sorted.insert(make_pair(delays[i], table.getPCB(i)));
+    }
+    double mapAdd = since(t1);
+    t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < size; i += 2) {
+        sorted.erase(iters[i]);
+    }
+    double mapCancel = since(t1);
+    t1 = std::chrono::high_resolution_clock::now();
+    int mapExpired = 0;
+    vector<PCB *> batch;
+    ReadyQueue mapQueue;
+    for (uint64_t t = 1; t <= maxDelay; t++) {
+        batch.clear();
+        while (!sorted.empty() && sorted.begin()->first <= t) {
+            batch.push_back(sorted.begin()->second);
+            sorted.erase(sorted.begin());
+        }
+        if (!batch.empty()) {
+            mapExpired += mapQueue.addPCBs(batch.data(), (int) batch.size());
+        }
+    }
+    double mapExpire = since(t1);
+
+    ok = ok && wheelExpired == mapExpired && wheelExpired == size / 2 && queue.size() == size / 2;
+    cout << "TimingWheel: add " << wheelAdd << " s, cancel " << wheelCancel << " s, expire " << wheelExpire
+         << " s" << endl;
+    cout << "multimap   : add " << mapAdd << " s, cancel " << mapCancel << " s, expire " << mapExpire << " s" << endl;
+    cout << "Speedup: add " << mapAdd / wheelAdd << "x, cancel " << mapCancel / wheelCancel << "x, expire "
+         << mapExpire / wheelExpire << "x, total "
+         << (mapAdd + mapCancel + mapExpire) / (wheelAdd + wheelCancel + wheelExpire) << "x" << endl;
+    cout << (ok ? "Both moved the same number of processes to the ready queue" : "ERROR: expiry counts differ")
+         << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test12.cpp
+ * @brief This file exercises the hot-path counters: two dispatcher threads share a ReadyQueue and a PCBTable
+ * while a monitor thread reads the counters without taking the queue's lock. At the end the counters are
+ * checked against the operations the dispatchers counted themselves.
+ * Build with "make clean; make STATS=-DSCHED_STATS" to turn the counters on; without it they read as zero and
+ * the run shows the cost of the queue without them.
+ * Usage: ./test12 [ops_per_thread]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+#include "readyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+// Number of dispatcher threads and PCBs per thread
+static const int NUM_THREADS = 2;
+static const int PCBS_PER_THREAD = 500;
+
+// State shared by the threads
+struct Shared {
+    AgingReadyQueue queue;
+    PCBTable table;
+    pthread_mutex_t lock;
+    int ops;
+    atomic<bool> done;
+    Shared() : table(NUM_THREADS * PCBS_PER_THREAD), done(false) {
+        pthread_mutex_init(&lock, NULL);
+    }
+    ~Shared() {
+        pthread_mutex_destroy(&lock);
+    }
+};
+
+// The arguments and results of one dispatcher thread
+struct Worker {
+    int id;
+    Shared *shared;
+    // PCBs this worker has removed and may add back
+    vector<PCB *> idle;
+    uint64_t removes;
+    uint64_t inserts;
+    uint64_t lookups;
+};
+
+/**
+ * @brief The body of a dispatcher: the test2 operation mix on the shared queue, plus a PID lookup per add.
+ */
+void *run_worker(void *param) {
+    Worker *w = (Worker *) param;
+    Shared *s = w->shared;
+    mt19937 rng(w->id + 1);
+    for (int i = 0; i < s->ops; i++) {
+        if (rng() % 2 == 0) {
+            pthread_mutex_lock(&s->lock);
+            PCB *pcb = s->queue.removePCB();
+            pthread_mutex_unlock(&s->lock);
+            if (pcb != NULL) {
+                w->idle.push_back(pcb);
+                w->removes++;
+            }
+        } else if (!w->idle.empty()) {
+            size_t idx = rng() % w->idle.size();
+            PCB *pcb = w->idle[idx];
+            w->idle[idx] = w->idle.back();
+            w->idle.pop_back();
+            pcb->setPriority(rng() % 50 + 1);
+            pthread_mutex_lock(&s->lock);
+            s->table.findByPID(pcb->getID());
+            s->queue.addPCB(pcb);
+            pthread_mutex_unlock(&s->lock);
+            w->lookups++;
+            w->inserts++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief The body of the monitor: read the counters every millisecond without the lock, and check that
+ * they never go backwards.
+ *
+ * @param param: the Shared state
+ * @return void*: one more than the number of snapshots taken, or NULL if a counter went backwards
+ */
+void *run_monitor(void *param) {
+    Shared *s = (Shared *) param;
+    uint64_t snapshots = 0;
+    ReadyQueueStats last = s->queue.stats();
+    while (!s->done.load()) {
+        ReadyQueueStats now = s->queue.stats();
+        if (now.inserts < last.inserts || now.removes < last.removes) {
+            return NULL;
+        }
+        last = now;
+        snapshots++;
+        usleep(1000);
+    }
+    return (void *) (snapshots + 1);
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 12********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    Shared *s = new Shared();
+    s->ops = (argc > 1) ? atoi(argv[1]) : 1000000;
+    if (s->ops <= 0) {
+        cerr << "Usage: " << argv[0] << " [ops_per_thread]" << endl;
+        return 1;
+    }
+    s->queue.setAgingRate(100);
+
+    Worker workers[NUM_THREADS];
+    uint64_t initial = 0;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        workers[t] = Worker{t, s, vector<PCB *>(), 0, 0, 0};
+        for (int i = 0; i < PCBS_PER_THREAD; i++) {
+            int idx = t * PCBS_PER_THREAD + i;
+            s->table.addNewPCB(idx + 1, rand() % 50 + 1, idx);
+            if (i % 2 == 0) {
+                s->queue.addPCB(s->table.getPCB(idx));
+                initial++;
+            } else {
+                workers[t].idle.push_back(s->table.getPCB(idx));
+            }
+        }
+    }
+
+    pthread_t threads[NUM_THREADS];
+    pthread_t monitor;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    pthread_create(&monitor, NULL, run_monitor, s);
+    for (int t = 0; t < NUM_THREADS; t++) {
+        pthread_create(&threads[t], NULL, run_worker, &workers[t]);
+    }
+    for (int t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    s->done.store(true);
+    void *snapshots;
+    pthread_join(monitor, &snapshots);
+    std::chrono::duration<double> runtime = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+    std::cout << "Time taken: " << runtime.count() << " seconds" << std::endl;
+
+    uint64_t inserts = initial, removes = 0, lookups = 0;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        inserts += workers[t].inserts;
+        removes += workers[t].removes;
+        lookups += workers[t].lookups;
+    }
+    ReadyQueueStats q = s->queue.stats();
+    PCBTableStats p = s->table.stats();
+    bool ok;
+    if (SCHED_STATS_ENABLED) {
+        cout << "ReadyQueue: inserts " << q.inserts << ", removes " << q.removes << ", max depth " << q.maxDepth
+             << ", aging steps " << q.agingSteps << ", aged PCBs " << q.agedPCBs << endl;
+        cout << "Transitions: NEW->READY " << q.transitions[(int) ProcState::NEW][(int) ProcState::READY]
+             << ", RUNNING->READY " << q.transitions[(int) ProcState::RUNNING][(int) ProcState::READY]
+             << ", READY->RUNNING " << q.transitions[(int) ProcState::READY][(int) ProcState::RUNNING] << endl;
+        cout << "PCBTable: fills " << p.fills << ", PID lookups " << p.pidLookups << ", misses " << p.pidMisses
+             << ", max live " << p.maxLive << endl;
+        cout << "Monitor read the counters " << (uintptr_t) snapshots - 1 << " times while the queue was running" << endl;
+        ok = q.inserts == inserts && q.removes == removes &&
+             q.transitions[(int) ProcState::READY][(int) ProcState::RUNNING] == removes &&
+             q.transitions[(int) ProcState::NEW][(int) ProcState::READY] +
+                     q.transitions[(int) ProcState::RUNNING][(int) ProcState::READY] == inserts &&
+             p.fills == (uint64_t) NUM_THREADS * PCBS_PER_THREAD && p.pidLookups == lookups && p.pidMisses == 0 &&
+             snapshots != NULL;
+        cout << (ok ? "Counters match the operations performed" : "ERROR: counters do not match") << endl;
+    } else {
+        cout << "Counters are compiled out; build with make STATS=-DSCHED_STATS to enable them" << endl;
+        ok = q.inserts == 0 && p.fills == 0;
+    }
+    delete s;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test13.cpp
+ * @brief This file tests the handles of the ReadyQueue: updatePriority moves a queued PCB to a new level,
+ * erase takes it out, and handles of PCBs that left the queue are rejected.
+ * Usage: ./test13
+ */
+#include <iostream>
+#include "readyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 13********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    ReadyQueue q1;
+    PCBTable table;
+    for (int i = 1; i <= 50; i++) {
+        // Add a new PCB with id = i, priority = i to the table at index i
+        table.addNewPCB(i, i, i);
+    }
+
+    std::cout << "Add processes 10, 20, 30 and 40 to q1, raise process 10 to priority 45 and erase process 30" << std::endl;
+    ReadyQueue::Handle h10 = q1.addPCB(table.getPCB(10));
+    ReadyQueue::Handle h20 = q1.addPCB(table.getPCB(20));
+    ReadyQueue::Handle h30 = q1.addPCB(table.getPCB(30));
+    q1.addPCB(table.getPCB(40));
+    bool ok = q1.updatePriority(h10, 45) && table.getPCB(10)->getPriority() == 45;
+    PCB *p = q1.erase(h30);
+    ok = ok && p == table.getPCB(30) && q1.size() == 3;
+    p->setState(ProcState::WAITING);
+    q1.displayAll();
+
+    // The handle of the erased PCB is stale for both operations
+    bool rejected = q1.erase(h30) == NULL && !q1.updatePriority(h30, 5);
+    std::cout << "Handles of processes that left the queue are rejected: erase again returns "
+              << (rejected ? "NULL" : "a PCB") << std::endl;
+
+    std::cout << "Dispatch the remaining processes" << std::endl;
+    const unsigned int expected[] = {10, 40, 20};
+    for (unsigned int id : expected) {
+        p = q1.removePCB();
+        p->display();
+        ok = ok && p->getID() == id;
+    }
+    rejected = rejected && q1.erase(h20) == NULL && q1.erase(h10) == NULL;
+    ok = ok && rejected && q1.size() == 0;
+    std::cout << (ok ? "Handles behave as expected" : "ERROR: handles do not behave as expected") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test14.cpp
+ * @brief This file tests the handles of the PCBTable: releasePCB frees a slot for allocPCB, and the
+ * generation in the handle makes handles kept past releasePCB stale.
+ * Usage: ./test14
+ */
+#include <iostream>
+#include "pcbtable.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 14********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    PCBTable table;
+    for (int i = 1; i <= 50; i++) {
+        // Add a new PCB with id = i, priority = i to the table at index i
+        table.addNewPCB(i, i, i);
+    }
+
+    std::cout << "Release process 20 from the table and create process 51" << std::endl;
+    PCBTable::Handle h20 = table.getHandle(20);
+    bool ok = table.getPCB(h20) == table.getPCB(20) && table.releasePCB(h20);
+    PCBTable::Handle h51 = table.allocPCB(51, 25);
+    ok = ok && h51.value != PCBTable::INVALID_HANDLE.value && table.getPCB(h51) != NULL;
+    if (ok) {
+        table.getPCB(h51)->display();
+        ok = table.getPCB(h51)->getID() == 51 && table.getPCB(h51)->getPriority() == 25;
+    }
+
+    // The released handle stays stale even when its slot has been handed out again
+    bool rejected = table.getPCB(h20) == NULL && !table.releasePCB(h20);
+    std::cout << "Handles of released processes are rejected: process 20 is "
+              << (rejected ? "NULL" : "still there") << std::endl;
+
+    // A second PCB with an ID the table already holds is refused
+    std::cout << "Create process 51 again" << std::endl;
+    rejected = rejected && table.allocPCB(51, 30).value == PCBTable::INVALID_HANDLE.value;
+    ok = ok && rejected && table.releasePCB(h51) && table.getPCB(h51) == NULL;
+
+    // With a single slot the next PCB must reuse it, so only the generation tells the handles apart
+    std::cout << "Create process 60 in a table with one slot, release it and create process 61" << std::endl;
+    PCBTable small(1);
+    PCBTable::Handle h60 = small.allocPCB(60, 10);
+    small.releasePCB(h60);
+    PCBTable::Handle h61 = small.allocPCB(61, 11);
+    rejected = small.getPCB(h60) == NULL && !small.releasePCB(h60);
+    std::cout << "Process 61 reuses slot " << PCBTable::indexOf(h61) << " and the handle of process 60 is "
+              << (rejected ? "NULL" : "still there") << std::endl;
+    ok = ok && rejected && PCBTable::indexOf(h61) == PCBTable::indexOf(h60) && h61.value != h60.value
+         && small.getPCB(h61) != NULL && small.getPCB(h61)->getID() == 61;
+    std::cout << (ok ? "Handles behave as expected" : "ERROR: handles do not behave as expected") << std::endl;
+    return ok ? 0 : 1;
+}
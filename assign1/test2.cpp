@@ -32,9 +32,8 @@ int main(int argc, char *argv[]) {
     // Randomly choose to add half of the processes into the ready queue
     for (int i = 0; i < size; i++) {
         int priority = rand() % 50 + 1;
-        PCB *pcbPtr = new PCB(i + 1, priority);
-        table.addPCB(pcbPtr, i);
-        if (rand() % 2 == 0) q2.addPCB(pcbPtr);
+        table.addNewPCB(i + 1, priority, i);
+        if (rand() % 2 == 0) q2.addPCB(table.getPCB(i));
     }
     cout << "Initial ReadyQueue size = " << q2.size() << endl;
     //q2.display();
@@ -0,0 +1,170 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test3.cpp
+ * @brief This file runs the test2 workload on several dispatcher threads sharing a ShardedReadyQueue
+ * and reports how the throughput scales with the number of threads.
+ * Usage: ./test3 [max_threads] [tolerance]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+#include "shardedreadyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+// Number of PCBs owned by each worker, as in test2
+static const int PCBS_PER_THREAD = 500;
+// Number of queue operations performed by each worker, as in test2
+static const int OPS_PER_THREAD = 1000000;
+
+// The arguments and results of one worker thread
+struct Worker {
+    // The worker's shard in the queue
+    int id;
+    ShardedReadyQueue *queue;
+    // PCBs this worker has removed from the queue and may add back. A PCB belongs to whichever worker
+    // removed it last, so only one thread ever touches a PCB that is outside the queue.
+    vector<PCB *> idle;
+    int removes;
+    int inserts;
+};
+
+/**
+ * @brief The body of a worker thread: the test2 operation mix against the worker's shard.
+ *
+ * @param param: the Worker of this thread
+ * @return void*: NULL
+ */
+void *run_worker(void *param) {
+    Worker *w = (Worker *) param;
+    mt19937 rng(w->id + 1);
+    for (int i = 0; i < OPS_PER_THREAD; i++) {
+        if (rng() % 2 == 0) {
+            // Remove a proc from ReadyQueue, possibly stolen from another worker's shard
+            PCB *pcb = w->queue->removePCB(w->id);
+            if (pcb != NULL) {
+                w->idle.push_back(pcb);
+                w->removes++;
+            }
+        } else if (!w->idle.empty()) {
+            // Add one of the worker's idle PCBs back with a random priority
+            size_t idx = rng() % w->idle.size();
+            PCB *pcb = w->idle[idx];
+            w->idle[idx] = w->idle.back();
+            w->idle.pop_back();
+            pcb->setPriority(rng() % 50 + 1);
+            w->queue->addPCB(pcb, w->id);
+            w->inserts++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run the workload on the given number of threads.
+ *
+ * @param threads: the number of worker threads (and shards)
+ * @param tolerance: the priority tolerance of the queue
+ * @param baseline: the throughput of the single-thread run, or 0 if this is that run
+ * @return double: the throughput in operations per second
+ */
+double run_test(int threads, unsigned int tolerance, double baseline) {
+    ShardedReadyQueue queue(threads, tolerance);
+    PCBTable table(threads * PCBS_PER_THREAD);
+    vector<Worker> workers(threads);
+
+    // Give each worker its own PCBs and randomly add half of them into its shard
+    srand(1);
+    for (int t = 0; t < threads; t++) {
+        workers[t].id = t;
+        workers[t].queue = &queue;
+        workers[t].removes = 0;
+        workers[t].inserts = 0;
+        for (int i = 0; i < PCBS_PER_THREAD; i++) {
+            int idx = t * PCBS_PER_THREAD + i;
+            table.addNewPCB(idx + 1, rand() % 50 + 1, idx);
+            if (rand() % 2 == 0) {
+                queue.addPCB(table.getPCB(idx), t);
+            } else {
+                workers[t].idle.push_back(table.getPCB(idx));
+            }
+        }
+    }
+
+    vector<pthread_t> tids(threads);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&tids[t], NULL, run_worker, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> runtime = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+
+    // Every PCB must be either in the queue or held by exactly one worker
+    int removes = 0, inserts = 0, idle = 0;
+    for (int t = 0; t < threads; t++) {
+        removes += workers[t].removes;
+        inserts += workers[t].inserts;
+        idle += (int) workers[t].idle.size();
+    }
+    bool consistent = (queue.size() + idle == threads * PCBS_PER_THREAD);
+
+    double ops = (double) threads * OPS_PER_THREAD;
+    double throughput = ops / runtime.count();
+    cout << "Threads: " << threads
+         << ", Time taken: " << runtime.count() << " seconds"
+         << ", Throughput: " << throughput / 1e6 << " Mops/s"
+         << ", Speedup: " << (baseline > 0 ? throughput / baseline : 1.0)
+         << ", # of removes = " << removes << ", # of inserts = " << inserts
+         << (consistent ? "" : ", INCONSISTENT") << endl;
+    return throughput;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 3********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    // Default to one thread per online core, and always show at least a few data points
+    int maxThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (maxThreads < 4) {
+        maxThreads = 4;
+    }
+    unsigned int tolerance = 0;
+    if (argc > 1) {
+        maxThreads = atoi(argv[1]);
+        if (maxThreads < 1) {
+            cerr << "Usage: " << argv[0] << " [max_threads >= 1] [tolerance]" << endl;
+            return 1;
+        }
+    }
+    if (argc > 2) {
+        tolerance = (unsigned int) atoi(argv[2]);
+    }
+    cout << "Priority tolerance = " << tolerance << ", online cores = " << sysconf(_SC_NPROCESSORS_ONLN) << endl;
+
+    // Double the number of threads each run, finishing with exactly maxThreads
+    vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);
+
+    double baseline = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        double throughput = run_test(counts[i], tolerance, baseline);
+        if (i == 0) {
+            baseline = throughput;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test4.cpp
+ * @brief This file stress tests the lock-free ConcurrentReadyQueue and compares its throughput with a
+ * ReadyQueue guarded by a single mutex, at 1, 2, 4, 8 and 16 threads.
+ * Usage: ./test4 [ops_per_thread]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <pthread.h>
+#include "concurrentreadyqueue.h"
+#include "readyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+// Number of PCBs owned by each thread, as in test2
+static const int PCBS_PER_THREAD = 500;
+
+/**
+ * @brief A ReadyQueue that every thread shares through one mutex, the baseline for the comparison.
+ */
+class MutexReadyQueue {
+private:
+    pthread_mutex_t lock;
+    ReadyQueue queue;
+
+public:
+    // ReadyQueue grows on demand, so the capacity hint is ignored
+    MutexReadyQueue(int capacityPerLevel) {
+        pthread_mutex_init(&lock, NULL);
+    }
+
+    ~MutexReadyQueue() {
+        pthread_mutex_destroy(&lock);
+    }
+
+    bool addPCB(PCB *pcbPtr) {
+        pthread_mutex_lock(&lock);
+        bool added = queue.addPCB(pcbPtr).index >= 0;
+        pthread_mutex_unlock(&lock);
+        return added;
+    }
+
+    PCB* removePCB() {
+        pthread_mutex_lock(&lock);
+        PCB *pcb = queue.removePCB();
+        pthread_mutex_unlock(&lock);
+        return pcb;
+    }
+
+    int size() {
+        pthread_mutex_lock(&lock);
+        int n = queue.size();
+        pthread_mutex_unlock(&lock);
+        return n;
+    }
+};
+
+// The arguments and results of one worker thread
+template <typename Queue>
+struct Worker {
+    int id;
+    Queue *queue;
+    int ops;
+    // PCBs this thread has removed from the queue and may add back. A PCB belongs to whichever thread
+    // removed it last, so only one thread ever touches a PCB that is outside the queue.
+    vector<PCB *> idle;
+    // Number of removed PCBs that were not in RUNNING state, which would mean a PCB was handed out twice
+    int badStates;
+};
+
+/**
+ * @brief The body of a worker thread: the test2 operation mix against the shared queue.
+ *
+ * @param param: the Worker of this thread
+ * @return void*: NULL
+ */
+template <typename Queue>
+void *run_worker(void *param) {
+    Worker<Queue> *w = (Worker<Queue> *) param;
+    mt19937 rng(w->id + 1);
+    for (int i = 0; i < w->ops; i++) {
+        if (rng() % 2 == 0) {
+            PCB *pcb = w->queue->removePCB();
+            if (pcb != NULL) {
+                if (pcb->getState() != ProcState::RUNNING) {
+                    w->badStates++;
+                }
+                w->idle.push_back(pcb);
+            }
+        } else if (!w->idle.empty()) {
+            // Add one of the thread's idle PCBs back with a random priority
+            size_t idx = rng() % w->idle.size();
+            PCB *pcb = w->idle[idx];
+            w->idle[idx] = w->idle.back();
+            w->idle.pop_back();
+            pcb->setPriority(rng() % 50 + 1);
+            if (!w->queue->addPCB(pcb)) {
+                // Still this thread's to add back later
+                w->idle.push_back(pcb);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Run the workload on one queue type and check that no PCB was lost or duplicated.
+ *
+ * @param name: the name of the queue type to print
+ * @param threads: the number of threads sharing the queue
+ * @param ops: the number of operations per thread
+ * @param consistent: set to false if a PCB was lost or duplicated, or the queue drained out of order
+ * @return double: the throughput in operations per second
+ */
+template <typename Queue>
+double run_test(const char *name, int threads, int ops, bool &consistent) {
+    int total = threads * PCBS_PER_THREAD;
+    // Every PCB could end up at the same priority level
+    Queue queue(total);
+    PCBTable table(total);
+    vector<Worker<Queue>> workers(threads);
+
+    // Give each thread its own PCBs and randomly add half of them into the queue
+    srand(1);
+    for (int t = 0; t < threads; t++) {
+        workers[t].id = t;
+        workers[t].queue = &queue;
+        workers[t].ops = ops;
+        workers[t].badStates = 0;
+        for (int i = 0; i < PCBS_PER_THREAD; i++) {
+            int idx = t * PCBS_PER_THREAD + i;
+            table.addNewPCB(idx, rand() % 50 + 1, idx);
+            if (rand() % 2 == 0) {
+                queue.addPCB(table.getPCB(idx));
+            } else {
+                workers[t].idle.push_back(table.getPCB(idx));
+            }
+        }
+    }
+
+    vector<pthread_t> tids(threads);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int t = 0; t < threads; t++) {
+        pthread_create(&tids[t], NULL, run_worker<Queue>, &workers[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> runtime = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+
+    // Every PCB must now be held by exactly one thread or still be in the queue, which must drain in
+    // non-increasing priority order
+    vector<int> seen(total, 0);
+    int badStates = 0;
+    for (int t = 0; t < threads; t++) {
+        badStates += workers[t].badStates;
+        for (size_t i = 0; i < workers[t].idle.size(); i++) {
+            seen[workers[t].idle[i]->getID()]++;
+        }
+    }
+    bool ordered = true;
+    unsigned int last = ConcurrentReadyQueue::MAX_PRIORITY;
+    for (PCB *pcb = queue.removePCB(); pcb != NULL; pcb = queue.removePCB()) {
+        seen[pcb->getID()]++;
+        ordered = ordered && pcb->getPriority() <= last;
+        last = pcb->getPriority();
+    }
+    consistent = badStates == 0 && ordered;
+    for (int i = 0; i < total; i++) {
+        consistent = consistent && seen[i] == 1;
+    }
+
+    double throughput = (double) threads * ops / runtime.count();
+    cout << name << ": Threads: " << threads
+         << ", Time taken: " << runtime.count() << " seconds"
+         << ", Throughput: " << throughput / 1e6 << " Mops/s"
+         << (consistent ? ", OK" : ", FAILED") << endl;
+    return throughput;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 4********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    int ops = 200000;
+    if (argc > 1) {
+        ops = atoi(argv[1]);
+        if (ops < 1) {
+            cerr << "Usage: " << argv[0] << " [ops_per_thread >= 1]" << endl;
+            return 1;
+        }
+    }
+
+    const int threadCounts[] = {1, 2, 4, 8, 16};
+    bool ok = true;
+    for (int threads : threadCounts) {
+        bool lockedOk, lockFreeOk;
+        double locked = run_test<MutexReadyQueue>("Mutex ReadyQueue    ", threads, ops, lockedOk);
+        double lockFree = run_test<ConcurrentReadyQueue>("ConcurrentReadyQueue", threads, ops, lockFreeOk);
+        cout << "Lock-free speedup at " << threads << " threads: " << lockFree / locked << endl;
+        ok = ok && lockedOk && lockFreeOk;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test5.cpp
+ * @brief This file compares bulk queries over a PCBTable of heap PCBs with the same queries over
+ * PCBColumns, the structure-of-arrays layout, and checks that both give the same answers.
+ * Usage: ./test5 [number_of_processes]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "pcbtable.h"
+#include "pcbcolumns.h"
+
+using namespace std;
+
+// Number of times each query is repeated; the average time is reported
+static const int REPEAT = 20;
+
+/**
+ * @brief Count the processes in a given state by visiting every PCB of the table.
+ */
+int count_by_state(PCBTable &table, ProcState state) {
+    int n = table.capacity();
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        PCB *pcb = table.getPCB((unsigned int) i);
+        if (pcb != NULL && pcb->getState() == state) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Find the highest priority among the processes in a given state by visiting every PCB of the table.
+ */
+unsigned int max_priority(PCBTable &table, ProcState state) {
+    int n = table.capacity();
+    unsigned int best = 0;
+    for (int i = 0; i < n; i++) {
+        PCB *pcb = table.getPCB((unsigned int) i);
+        if (pcb != NULL && pcb->getState() == state && pcb->getPriority() > best) {
+            best = pcb->getPriority();
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Collect the slots whose priority is within [low, high] by visiting every PCB of the table.
+ */
+int filter_by_priority(PCBTable &table, unsigned int low, unsigned int high, vector<uint32_t> &out) {
+    int n = table.capacity();
+    out.clear();
+    for (int i = 0; i < n; i++) {
+        PCB *pcb = table.getPCB((unsigned int) i);
+        if (pcb != NULL && pcb->getPriority() >= low && pcb->getPriority() <= high) {
+            out.push_back(i);
+        }
+    }
+    return (int) out.size();
+}
+
+/**
+ * @brief Move every process in state "from" to state "to" by visiting every PCB of the table.
+ */
+int transition_state(PCBTable &table, ProcState from, ProcState to) {
+    int n = table.capacity();
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        PCB *pcb = table.getPCB((unsigned int) i);
+        if (pcb != NULL && pcb->getState() == from) {
+            pcb->setState(to);
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Time a query, repeating it REPEAT times.
+ *
+ * @param query: the query to run; returns a value that is folded into the checksum
+ * @param checksum: receives the sum of all results, so the work cannot be optimized away
+ * @return double: the average time per query in milliseconds
+ */
+template <typename Query>
+double time_query(Query query, long &checksum) {
+    checksum = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < REPEAT; r++) {
+        checksum += query();
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> runtime = t2 - t1;
+    return runtime.count() / REPEAT;
+}
+
+/**
+ * @brief Print one row of the comparison. The columns are only valid until the table changes, so the speedup
+ * of a query that has to reload them first is printed too.
+ *
+ * @param load: the time of PCBColumns::load in ms
+ */
+void report(const char *name, double aos, double soa, double load, bool same) {
+    cout << name << ": pointer table " << aos << " ms, columns " << soa << " ms, speedup " << aos / soa
+         << ", with load " << aos / (soa + load) << (same ? ", results match" : ", RESULTS DIFFER") << endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 5********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    int size = 1000000;
+    if (argc > 1) {
+        size = atoi(argv[1]);
+        if (size < 1) {
+            cerr << "Usage: " << argv[0] << " [number_of_processes >= 1]" << endl;
+            return 1;
+        }
+    }
+
+    // Heap PCBs are placed in random slots, as they would be after a long run of process churn,
+    // so walking the slots in order does not walk the heap in order
+    PCBTable table(size);
+    vector<unsigned int> slots(size);
+    for (int i = 0; i < size; i++) {
+        slots[i] = i;
+    }
+    mt19937 rng(1);
+    shuffle(slots.begin(), slots.end(), rng);
+    const ProcState allStates[] = {ProcState::NEW, ProcState::READY, ProcState::RUNNING,
+                                   ProcState::WAITING, ProcState::TERMINATED};
+    for (int i = 0; i < size; i++) {
+        PCB *pcb = new PCB(i + 1, rng() % 50 + 1, allStates[rng() % 5]);
+        table.addPCB(pcb, slots[i]);
+    }
+    PCBColumns columns;
+    columns.load(table);
+    cout << "Number of processes = " << size << ", repeats per query = " << REPEAT << endl;
+
+    long aosSum, soaSum;
+    double aos, soa;
+    // Every query below depends on this copy, which is out of date as soon as the table changes
+    long loadSum;
+    double load = time_query([&]() { columns.load(table); return columns.size(); }, loadSum);
+    cout << "Load columns: " << load << " ms" << endl;
+
+    aos = time_query([&]() { return count_by_state(table, ProcState::READY); }, aosSum);
+    soa = time_query([&]() { return columns.countByState(ProcState::READY); }, soaSum);
+    report("Count READY          ", aos, soa, load, aosSum == soaSum);
+
+    aos = time_query([&]() { return max_priority(table, ProcState::WAITING); }, aosSum);
+    soa = time_query([&]() { return columns.maxPriority(ProcState::WAITING); }, soaSum);
+    report("Max priority WAITING ", aos, soa, load, aosSum == soaSum);
+
+    vector<uint32_t> aosOut, soaOut;
+    aos = time_query([&]() { return filter_by_priority(table, 20, 30, aosOut); }, aosSum);
+    soa = time_query([&]() { return columns.filterByPriority(20, 30, soaOut); }, soaSum);
+    report("Priority in [20, 30] ", aos, soa, load, aosSum == soaSum && aosOut == soaOut);
+
+    // Each repeat moves the processes back and forth, so every run does the same amount of work. Start
+    // with no READY process, so that both sides see the same counts in every round and end where they began.
+    transition_state(table, ProcState::READY, ProcState::WAITING);
+    columns.load(table);
+    int round = 0;
+    aos = time_query([&]() {
+        return (round++ % 2 == 0) ? transition_state(table, ProcState::WAITING, ProcState::READY)
+                                  : transition_state(table, ProcState::READY, ProcState::WAITING);
+    }, aosSum);
+    round = 0;
+    soa = time_query([&]() {
+        return (round++ % 2 == 0) ? columns.transitionState(ProcState::WAITING, ProcState::READY, table)
+                                  : columns.transitionState(ProcState::READY, ProcState::WAITING, table);
+    }, soaSum);
+    // The columns write the transitions back, so the table must agree with them afterwards
+    bool synced = count_by_state(table, ProcState::WAITING) == columns.countByState(ProcState::WAITING) &&
+                  count_by_state(table, ProcState::READY) == columns.countByState(ProcState::READY);
+    columns.transitionState(ProcState::WAITING, ProcState::READY, table);
+    synced = synced && count_by_state(table, ProcState::READY) == columns.countByState(ProcState::READY) &&
+             count_by_state(table, ProcState::WAITING) == 0;
+    report("WAITING <-> READY    ", aos, soa, load, aosSum == soaSum && synced);
+    return 0;
+}
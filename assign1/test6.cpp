@@ -0,0 +1,140 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test6.cpp
+ * @brief This file compares the batch APIs addPCBs/removeTopK with the same work done one PCB at a time,
+ * on a dispatcher that admits processes in bursts and dispatches them to a pool of CPUs.
+ * Usage: ./test6 [processes_per_configuration]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "readyqueue.h"
+#include "shardedreadyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+// Number of CPUs that receive a process in each dispatch step
+static const int NUM_CPUS = 8;
+
+// Adapters that give both queues the same single and batch interface. The sharded queue has one shard,
+// so each call pays for one lock, as a dispatcher sharing the queue with other threads would.
+struct ReadyQueueAdapter {
+    ReadyQueue queue;
+    void add(PCB *pcb) { queue.addPCB(pcb); }
+    PCB *remove() { return queue.removePCB(); }
+    int addBatch(PCB *const *pcbs, int n) { return queue.addPCBs(pcbs, n); }
+    int removeBatch(int k, PCB **out) { return queue.removeTopK(k, out); }
+};
+
+struct ShardedAdapter {
+    ShardedReadyQueue queue;
+    ShardedAdapter() : queue(1) {}
+    void add(PCB *pcb) { queue.addPCB(pcb, 0); }
+    PCB *remove() { return queue.removePCB(0); }
+    int addBatch(PCB *const *pcbs, int n) { return queue.addPCBs(pcbs, n, 0); }
+    int removeBatch(int k, PCB **out) { return queue.removeTopK(k, out, 0); }
+};
+
+/**
+ * @brief Admit bursts of processes and dispatch them NUM_CPUS at a time until the queue is empty.
+ *
+ * @param burst: the number of processes admitted at once
+ * @param rounds: the number of bursts
+ * @param batch: whether to use addPCBs/removeTopK or addPCB/removePCB
+ * @param order: receives the IDs of the dispatched processes, in dispatch order
+ * @return double: the time taken in seconds
+ */
+template <typename Adapter>
+double run_test(int burst, int rounds, bool batch, vector<unsigned int> &order) {
+    Adapter queue;
+    PCBTable table(burst);
+    mt19937 rng(1);
+    vector<PCB *> pcbs(burst);
+    for (int i = 0; i < burst; i++) {
+        table.addNewPCB(i + 1, 1, i);
+        pcbs[i] = table.getPCB(i);
+    }
+    order.clear();
+    order.reserve((size_t) burst * rounds);
+    PCB *cpus[NUM_CPUS];
+
+    std::chrono::duration<double> runtime(0);
+    for (int r = 0; r < rounds; r++) {
+        // Fresh priorities for every burst; not part of the timed work
+        for (int i = 0; i < burst; i++) {
+            pcbs[i]->setPriority(rng() % 50 + 1);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        if (batch) {
+            queue.addBatch(pcbs.data(), burst);
+        } else {
+            for (int i = 0; i < burst; i++) {
+                queue.add(pcbs[i]);
+            }
+        }
+        int dispatched;
+        do {
+            if (batch) {
+                dispatched = queue.removeBatch(NUM_CPUS, cpus);
+            } else {
+                for (dispatched = 0; dispatched < NUM_CPUS; dispatched++) {
+                    cpus[dispatched] = queue.remove();
+                    if (cpus[dispatched] == NULL) {
+                        break;
+                    }
+                }
+            }
+            for (int c = 0; c < dispatched; c++) {
+                order.push_back(cpus[c]->getID());
+            }
+        } while (dispatched == NUM_CPUS);
+        auto t2 = std::chrono::high_resolution_clock::now();
+        runtime += t2 - t1;
+    }
+    return runtime.count();
+}
+
+/**
+ * @brief Compare the single and batch paths of one queue for one burst size.
+ */
+template <typename Adapter>
+void compare(const char *name, int burst, int rounds) {
+    vector<unsigned int> singleOrder, batchOrder;
+    double single = run_test<Adapter>(burst, rounds, false, singleOrder);
+    double batch = run_test<Adapter>(burst, rounds, true, batchOrder);
+    cout << name << ": Burst: " << burst
+         << ", one at a time: " << single << " seconds"
+         << ", batched: " << batch << " seconds"
+         << ", Speedup: " << single / batch
+         << (singleOrder == batchOrder ? ", same dispatch order" : ", DISPATCH ORDER DIFFERS") << endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 6********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    // Each configuration moves about rounds * burst processes through the queue
+    long total = 2000000;
+    if (argc > 1) {
+        total = atol(argv[1]);
+        if (total < 1) {
+            cerr << "Usage: " << argv[0] << " [processes_per_configuration >= 1]" << endl;
+            return 1;
+        }
+    }
+    cout << "Dispatching to " << NUM_CPUS << " CPUs, " << total << " processes per configuration" << endl;
+
+    const int bursts[] = {8, 64, 512, 4096};
+    for (int burst : bursts) {
+        int rounds = (int) (total / burst) + 1;
+        compare<ReadyQueueAdapter>("ReadyQueue       ", burst, rounds);
+        compare<ShardedAdapter>("ShardedReadyQueue", burst, rounds);
+    }
+    return 0;
+}
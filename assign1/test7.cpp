@@ -0,0 +1,126 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test7.cpp
+ * @brief This file checks PCBTable::findByPID with millions of live processes and sparse 32-bit PIDs, and
+ * compares the PID index with std::unordered_map, including the worst single insert (resize pauses).
+ * Usage: ./test7 [number_of_processes]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "pcbtable.h"
+#include "pidindex.h"
+
+using namespace std;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Nanoseconds between two time points.
+ */
+static double ns(Clock::time_point t1, Clock::time_point t2) {
+    return std::chrono::duration<double, std::nano>(t2 - t1).count();
+}
+
+/**
+ * @brief The i-th sparse PID. Multiplying by an odd constant is a bijection on 32-bit values, so the PIDs are
+ * unique but scattered over the whole range.
+ */
+static uint32_t pid_of(uint32_t i) {
+    return (i + 1) * 2246822519u;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 7********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    int size = 2000000;
+    if (argc > 1) {
+        size = atoi(argv[1]);
+        if (size < 2) {
+            cerr << "Usage: " << argv[0] << " [number_of_processes >= 2]" << endl;
+            return 1;
+        }
+    }
+    cout << "Number of processes = " << size << endl;
+
+    // Fill the table, timing each allocation to find the worst pause
+    PCBTable table(size);
+    vector<PCBTable::Handle> handles(size);
+    double worst = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < size; i++) {
+        auto t1 = Clock::now();
+        handles[i] = table.allocPCB(pid_of(i), i % 50 + 1);
+        auto t2 = Clock::now();
+        worst = max(worst, ns(t1, t2));
+    }
+    double total = ns(start, Clock::now());
+    cout << "PCBTable::allocPCB: " << total / size << " ns/op, worst single op " << worst / 1000 << " us" << endl;
+
+    // The same inserts into std::unordered_map, whose rehash moves every entry at once
+    unordered_map<uint32_t, uint32_t> map;
+    worst = 0;
+    start = Clock::now();
+    for (int i = 0; i < size; i++) {
+        auto t1 = Clock::now();
+        map[pid_of(i)] = i;
+        auto t2 = Clock::now();
+        worst = max(worst, ns(t1, t2));
+    }
+    total = ns(start, Clock::now());
+    cout << "unordered_map insert: " << total / size << " ns/op, worst single op " << worst / 1000 << " us" << endl;
+
+    // Look up PIDs in random order, half of them present and half absent
+    mt19937 rng(1);
+    vector<uint32_t> probes(size);
+    for (int i = 0; i < size; i++) {
+        uint32_t k = rng() % size;
+        probes[i] = (i % 2 == 0) ? pid_of(k) : pid_of(k + size);
+    }
+    int found = 0;
+    start = Clock::now();
+    for (int i = 0; i < size; i++) {
+        found += table.findByPID(probes[i]) != NULL;
+    }
+    total = ns(start, Clock::now());
+    cout << "PCBTable::findByPID: " << total / size << " ns/op, " << found << " hits" << endl;
+    int mapFound = 0;
+    start = Clock::now();
+    for (int i = 0; i < size; i++) {
+        mapFound += map.count(probes[i]) != 0;
+    }
+    total = ns(start, Clock::now());
+    cout << "unordered_map find: " << total / size << " ns/op, " << mapFound << " hits" << endl;
+
+    // Churn: release every other process and reuse the slots for new PIDs, then check every PID
+    for (int i = 0; i < size; i += 2) {
+        table.releasePCB(handles[i]);
+    }
+    for (int i = 0; i < size; i += 2) {
+        handles[i] = table.allocPCB(pid_of(i + size), 1);
+    }
+    bool correct = found == mapFound && table.count() == size;
+    for (int i = 0; i < size && correct; i++) {
+        uint32_t live = (i % 2 == 0) ? pid_of(i + size) : pid_of(i);
+        uint32_t gone = (i % 2 == 0) ? pid_of(i) : pid_of(i + size);
+        PCB *pcb = table.findByPID(live);
+        correct = pcb != NULL && pcb->getID() == live && table.findByPID(gone) == NULL;
+    }
+    cout << "PID index after churn: " << (correct ? "correct" : "INCORRECT") << endl;
+
+    // A second PCB with a live PID is refused, so removing either one can never hide the other
+    table.releasePCB(handles[0]);
+    bool refused = table.allocPCB(pid_of(1), 1).value == PCBTable::INVALID_HANDLE.value &&
+                   table.findByPID(pid_of(1)) == table.getPCB(handles[1]);
+    handles[0] = table.allocPCB(pid_of(size), 1);
+    refused = refused && table.findByPID(pid_of(size)) == table.getPCB(handles[0]) && table.count() == size;
+    cout << "Duplicate PID: " << (refused ? "refused" : "ACCEPTED") << endl;
+    return correct && refused ? 0 : 1;
+}
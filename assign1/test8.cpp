@@ -0,0 +1,225 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test8.cpp
+ * @brief This file compares configurations of the BasicReadyQueue template with a queue that takes the same
+ * choices (priority range, FIFO or LIFO within a priority) as constructor arguments, on the test2 workload.
+ * Usage: ./test8 [operations]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "readyqueue.h"
+#include "pcbtable.h"
+
+using namespace std;
+
+/**
+ * @brief The same bucket and bitmap queue as BasicReadyQueue, configured at run time: the buckets, bitmap and
+ * node pool are heap vectors sized in the constructor, the bitmap scan loops over a run-time number of words
+ * and the FIFO/LIFO choice is a branch on every add. It is the baseline for what the template parameters save.
+ */
+class RuntimeReadyQueue {
+private:
+    // Same node layout as BasicReadyQueue: doubly linked, with the generation used by handles
+    struct Node {
+        PCB *pcb;
+        int prev;
+        int next;
+        unsigned int priority;
+        unsigned int generation;
+    };
+    struct Bucket {
+        int head;
+        int tail;
+    };
+
+    unsigned int maxPriority;
+    bool fifo;
+    vector<Bucket> buckets;
+    vector<uint64_t> bitmap;
+    vector<Node> nodes;
+    int freeList;
+    int count;
+
+public:
+    RuntimeReadyQueue(unsigned int maxPriority, bool fifo)
+        : maxPriority(maxPriority), fifo(fifo), buckets(maxPriority + 1), bitmap(maxPriority / 64 + 1, 0),
+          freeList(-1), count(0) {
+        for (Bucket &b : buckets) {
+            b.head = -1;
+            b.tail = -1;
+        }
+    }
+
+    bool addPCB(PCB *pcb) {
+        unsigned int p = pcb->getPriority();
+        if (p < 1 || p > maxPriority) {
+            cerr << "RuntimeReadyQueue: priority " << p << " is out of range" << endl;
+            return false;
+        }
+        if (freeList < 0) {
+            nodes.push_back(Node{NULL, -1, -1, 0, 0});
+            freeList = (int) nodes.size() - 1;
+        }
+        int n = freeList;
+        freeList = nodes[n].next;
+        nodes[n].pcb = pcb;
+        nodes[n].priority = p;
+        Bucket &b = buckets[p];
+        if (fifo) {
+            nodes[n].prev = b.tail;
+            nodes[n].next = -1;
+            if (b.tail < 0) {
+                b.head = n;
+            } else {
+                nodes[b.tail].next = n;
+            }
+            b.tail = n;
+        } else {
+            nodes[n].prev = -1;
+            nodes[n].next = b.head;
+            if (b.head < 0) {
+                b.tail = n;
+            } else {
+                nodes[b.head].prev = n;
+            }
+            b.head = n;
+        }
+        bitmap[p / 64] |= (uint64_t) 1 << (p % 64);
+        count++;
+        pcb->setState(ProcState::READY);
+        return true;
+    }
+
+    PCB *removePCB() {
+        for (int w = (int) bitmap.size() - 1; w >= 0; w--) {
+            if (bitmap[w] != 0) {
+                unsigned int p = w * 64 + 63 - __builtin_clzll(bitmap[w]);
+                Bucket &b = buckets[p];
+                int n = b.head;
+                b.head = nodes[n].next;
+                if (b.head < 0) {
+                    b.tail = -1;
+                    bitmap[w] &= ~((uint64_t) 1 << (p % 64));
+                } else {
+                    nodes[b.head].prev = -1;
+                }
+                PCB *pcb = nodes[n].pcb;
+                nodes[n].pcb = NULL;
+                nodes[n].priority = 0;
+                nodes[n].generation++;
+                nodes[n].next = freeList;
+                freeList = n;
+                count--;
+                pcb->setState(ProcState::RUNNING);
+                return pcb;
+            }
+        }
+        return NULL;
+    }
+
+    int size() { return count; }
+};
+
+// One step of the test2 operation mix, drawn before the timed loop so that rand() is not timed
+struct Op {
+    bool remove;
+    int index;
+    unsigned int priority;
+};
+
+/**
+ * @brief Draw the test2 operation mix: each operation either removes the top PCB or re-adds a random process
+ * that is not READY with a new priority.
+ */
+static vector<Op> make_ops(unsigned int maxPriority, int operations) {
+    vector<Op> ops(operations);
+    srand(2);
+    for (Op &op : ops) {
+        op.remove = (rand() % 2 == 0);
+        op.index = rand() % 500;
+        op.priority = rand() % maxPriority + 1;
+    }
+    return ops;
+}
+
+/**
+ * @brief Run an operation mix on a queue. A random half of the 500 processes start in the queue.
+ *
+ * @param queue: an empty queue
+ * @param maxPriority: the priority range used for the initial priorities
+ * @param ops: the operations
+ * @param checksum: receives a hash of the dispatched process IDs, to compare dispatch orders
+ * @return double: the time taken in seconds
+ */
+template <typename Queue>
+double run_test(Queue &queue, unsigned int maxPriority, const vector<Op> &ops, unsigned long long &checksum) {
+    const int size = 500;
+    PCBTable table(size);
+    srand(1);
+    for (int i = 0; i < size; i++) {
+        table.addNewPCB(i + 1, rand() % maxPriority + 1, i);
+        if (rand() % 2 == 0) queue.addPCB(table.getPCB(i));
+    }
+    checksum = 0;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (const Op &op : ops) {
+        if (op.remove) {
+            PCB *pcb = queue.removePCB();
+            if (pcb != NULL) {
+                checksum = checksum * 31 + pcb->getID();
+            }
+        } else {
+            PCB *pcb = table.getPCB(op.index);
+            if (pcb->getState() != ProcState::READY) {
+                pcb->setPriority(op.priority);
+                queue.addPCB(pcb);
+            }
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> runtime = std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+    return runtime.count();
+}
+
+/**
+ * @brief Time one template configuration against the runtime queue with the same settings, and check that
+ * both dispatch the same processes in the same order.
+ */
+template <typename Queue>
+void compare(const char *name, unsigned int maxPriority, bool fifo, int operations) {
+    vector<Op> ops = make_ops(maxPriority, operations);
+    unsigned long long expected, actual;
+    RuntimeReadyQueue baseline(maxPriority, fifo);
+    double base = run_test(baseline, maxPriority, ops, expected);
+    Queue *queue = new Queue();   // FixedStorage pools are too large for the stack
+    double t = run_test(*queue, maxPriority, ops, actual);
+    delete queue;
+    cout << name << ": " << t << " s, runtime-configured queue: " << base << " s, speedup " << base / t << "x"
+         << (actual == expected ? "" : "  DISPATCH ORDER MISMATCH") << endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 8********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    int operations = (argc > 1) ? atoi(argv[1]) : 10000000;
+    if (operations <= 0) {
+        cerr << "Usage: " << argv[0] << " [operations]" << endl;
+        return 1;
+    }
+    cout << operations << " operations on 500 processes" << endl;
+
+    compare<ReadyQueue>("ReadyQueue (50, FIFO, dynamic)", 50, true, operations);
+    compare<BasicReadyQueue<50, FifoOrder, FixedStorage<512> > >("BasicReadyQueue<50, FIFO, fixed 512>", 50, true,
+                                                                 operations);
+    compare<BasicReadyQueue<50, LifoOrder, FixedStorage<512> > >("BasicReadyQueue<50, LIFO, fixed 512>", 50, false,
+                                                                 operations);
+    compare<BasicReadyQueue<255, FifoOrder, DynamicStorage> >("BasicReadyQueue<255, FIFO, dynamic>", 255, true,
+                                                             operations);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file test9.cpp
+ * @brief This file compares restarting from a PCBSnapshot with rebuilding the PCBTable and ReadyQueue one
+ * PCB at a time, and checks that the restored table and queue match the originals.
+ * Usage: ./test9 [processes] [snapshot_file]
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pcbsnapshot.h"
+
+using namespace std;
+
+/**
+ * @brief Seconds elapsed since t1.
+ */
+static double since(std::chrono::high_resolution_clock::time_point t1) {
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1).count();
+}
+
+/**
+ * @brief Check that the restored table holds the same PCBs, handles and PID lookups as the original.
+ */
+static bool same_table(PCBTable &a, PCBTable &b) {
+    if (a.capacity() != b.capacity() || a.count() != b.count()) {
+        return false;
+    }
+    for (int i = 0; i < a.capacity(); i++) {
+        PCB *x = a.getPCB(i);
+        PCB *y = b.getPCB(i);
+        if ((x == NULL) != (y == NULL) || a.getHandle(i).value != b.getHandle(i).value) {
+            return false;
+        }
+        if (x != NULL && (x->getID() != y->getID() || x->getPriority() != y->getPriority() ||
+                          x->getState() != y->getState() || b.findByPID(y->getID()) != y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "CS 433 Programming assignment 1" << std::endl;
+    std::cout << "Course: CS433 (Operating Systems)" << std::endl;
+    std::cout << "Description : Program to implement a priority ready queue of processes" << std::endl;
+    std::cout << "************Performing Test 9********************" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    int size = (argc > 1) ? atoi(argv[1]) : 1000000;
+    const char *path = (argc > 2) ? argv[2] : "test9.snapshot";
+    if (size <= 0) {
+        cerr << "Usage: " << argv[0] << " [processes] [snapshot_file]" << endl;
+        return 1;
+    }
+    srand(1);
+
+    // The current restart path: every PCB is added again with addNewPCB and half of them queued
+    PCBTable table(size);
+    ReadyQueue queue;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < size; i++) {
+        table.addNewPCB((i + 1) * 7919u, rand() % 50 + 1, i);
+        if (rand() % 2 == 0) queue.addPCB(table.getPCB(i));
+    }
+    double rebuild = since(t1);
+    // Some churn, so that the snapshot also carries free slots and bumped generations
+    for (int i = 0; i < size; i += 10) {
+        if (table.getPCB(i)->getState() != ProcState::READY) {
+            table.releasePCB(table.getHandle(i));
+        }
+    }
+    cout << size << " processes, " << table.count() << " in the table, " << queue.size() << " queued" << endl;
+    cout << "Rebuild with addNewPCB/addPCB: " << rebuild << " seconds" << endl;
+
+    int queued = queue.size();
+    t1 = std::chrono::high_resolution_clock::now();
+    if (!PCBSnapshot::save(path, table, queue)) {
+        return 1;
+    }
+    cout << "Save snapshot: " << since(t1) << " seconds" << endl;
+
+    PCBTable restored(0);
+    ReadyQueue restoredQueue;
+    t1 = std::chrono::high_resolution_clock::now();
+    if (!PCBSnapshot::load(path, restored, restoredQueue)) {
+        return 1;
+    }
+    double load = since(t1);
+    cout << "Load snapshot: " << load << " seconds (speedup " << rebuild / load << "x)" << endl;
+
+    bool ok = same_table(table, restored) && queue.size() == restoredQueue.size();
+    while (ok && queue.size() > 0) {
+        ok = queue.removePCB()->getID() == restoredQueue.removePCB()->getID();
+    }
+    // The restored table must keep working like a new one
+    PCBTable::Handle h = restored.allocPCB(1, 25);
+    ok = ok && restored.getPCB(h) != NULL && restored.findByPID(1) == restored.getPCB(h);
+    cout << (ok ? "Restored table and queue match the originals" : "ERROR: restored table or queue differs") << endl;
+
+    // A snapshot that queues the same slot twice must be refused. The queued slots end the file.
+    bool refused = true;
+    if (queued > 1) {
+        int fd = open(path, O_RDWR);
+        uint32_t first;
+        off_t end = lseek(fd, 0, SEEK_END);
+        refused = pread(fd, &first, sizeof(first), end - (off_t) queued * sizeof(uint32_t)) == sizeof(first) &&
+                  pwrite(fd, &first, sizeof(first), end - sizeof(uint32_t)) == sizeof(first);
+        close(fd);
+        PCBTable damaged(0);
+        ReadyQueue damagedQueue;
+        refused = refused && !PCBSnapshot::load(path, damaged, damagedQueue) && damagedQueue.size() == 0;
+        cout << (refused ? "Damaged snapshot: refused" : "ERROR: damaged snapshot was loaded") << endl;
+    }
+    // A queue that could not be restored as it is must not be saved
+    PCBTable small(4);
+    ReadyQueue smallQueue;
+    small.addNewPCB(1, 5, 0);
+    smallQueue.addPCB(small.getPCB(0));
+    small.getPCB(0)->setState(ProcState::WAITING);
+    bool notSaved = !PCBSnapshot::save(path, small, smallQueue);
+    cout << (notSaved ? "Queued PCB that is not READY: not saved" : "ERROR: queued PCB that is not READY was saved")
+         << endl;
+    unlink(path);
+    ok = ok && refused && notSaved;
+    return ok ? 0 : 1;
+}
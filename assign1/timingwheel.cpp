@@ -0,0 +1,271 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file timingwheel.cpp
+ * @brief This is the implementation file for the TimingWheel class.
+ */
+#include "timingwheel.h"
+
+const TimingWheel::Handle TimingWheel::INVALID_HANDLE = {-1, 0};
+
+static const uint64_t SLOT_MASK = TimingWheel::SLOTS - 1;
+
+// The number of ticks covered by the whole wheel
+static const uint64_t WHEEL_RANGE = (uint64_t)1 << (TimingWheel::SLOT_BITS * TimingWheel::LEVELS);
+
+/**
+ * @brief Construct a new TimingWheel object
+ *
+ * @param capacity: the number of timers to make room for up front; the pool grows beyond it as needed
+ * @param start: the tick the wheel starts at
+ */
+TimingWheel::TimingWheel(int capacity, uint64_t start) {
+    for (unsigned int i = 0; i < LEVELS * SLOTS; i++) {
+        heads[i] = -1;
+    }
+    for (unsigned int l = 0; l < LEVELS; l++) {
+        occupied[l] = 0;
+    }
+    nodes.reserve(capacity > 0 ? capacity : 0);
+    freeList = -1;
+    count = 0;
+    now = start;
+}
+
+/**
+ * @brief Link a node into the slot for its expiry time, relative to the current tick.
+ * A timer due within SLOTS^(l+1) ticks goes to level l, in the slot given by bits l*SLOT_BITS and up of its
+ * expiry time. That slot is cascaded exactly when the lower bits of the clock wrap to it, which is before
+ * the timer is due.
+ *
+ * @param n: a node that is not linked into any slot
+ */
+void TimingWheel::place(int n) {
+    Node &node = nodes[n];
+    uint64_t expires = node.expires;
+    // Timers beyond the range of the wheel wait in the top level and are placed again when it comes around
+    if (expires - now >= WHEEL_RANGE) {
+        expires = now + WHEEL_RANGE - 1;
+    }
+    uint64_t delta = expires - now;
+    unsigned int level = 0;
+    while (level + 1 < LEVELS && delta >= ((uint64_t)1 << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    unsigned int slot = (expires >> (SLOT_BITS * level)) & SLOT_MASK;
+    unsigned int list = level * SLOTS + slot;
+    node.slot = list + 1;
+    node.prev = -1;
+    node.next = heads[list];
+    if (heads[list] >= 0) {
+        nodes[heads[list]].prev = n;
+    }
+    heads[list] = n;
+    occupied[level] |= (uint64_t)1 << slot;
+}
+
+/**
+ * @brief Unlink a node from its slot list, clearing the slot's occupancy bit if it becomes empty.
+ *
+ * @param n: a node linked into a slot
+ */
+void TimingWheel::unlink(int n) {
+    Node &node = nodes[n];
+    unsigned int list = node.slot - 1;
+    if (node.prev < 0) {
+        heads[list] = node.next;
+    } else {
+        nodes[node.prev].next = node.next;
+    }
+    if (node.next >= 0) {
+        nodes[node.next].prev = node.prev;
+    }
+    if (heads[list] < 0) {
+        occupied[list / SLOTS] &= ~((uint64_t)1 << (list % SLOTS));
+    }
+}
+
+/**
+ * @brief Return a node to the free list and invalidate all handles to it.
+ *
+ * @param n: a node that has been unlinked from its slot
+ */
+void TimingWheel::release(int n) {
+    nodes[n].pcb = NULL;
+    nodes[n].slot = 0;
+    nodes[n].generation++;
+    nodes[n].next = freeList;
+    freeList = n;
+    count--;
+}
+
+/**
+ * @brief Empty the slot of an upper level that the clock has just reached and place its timers again.
+ * Each lands in a lower level, or in level 0 at the current tick if it is due now.
+ *
+ * @param level: the level to cascade, 1..LEVELS-1
+ */
+void TimingWheel::cascade(unsigned int level) {
+    unsigned int slot = (now >> (SLOT_BITS * level)) & SLOT_MASK;
+    unsigned int list = level * SLOTS + slot;
+    int n = heads[list];
+    heads[list] = -1;
+    occupied[level] &= ~((uint64_t)1 << slot);
+    while (n >= 0) {
+        int next = nodes[n].next;
+        place(n);
+        n = next;
+    }
+}
+
+/**
+ * @brief Expire every timer of the level 0 slot of the current tick, appending its PCB to the batch.
+ */
+void TimingWheel::expireCurrent() {
+    unsigned int slot = now & SLOT_MASK;
+    int n = heads[slot];
+    while (n >= 0) {
+        int next = nodes[n].next;
+        expired.push_back(nodes[n].pcb);
+        release(n);
+        n = next;
+    }
+    heads[slot] = -1;
+    occupied[0] &= ~((uint64_t)1 << slot);
+}
+
+/**
+ * @brief Find the next tick at which something happens: an occupied level 0 slot, or the cascade of an
+ * occupied slot of an upper level. Cascades of empty slots do nothing and are skipped.
+ * Level 0 slots at or before the current position hold timers of the next round, so while level 0 has any
+ * timers the search never goes past its next wrap.
+ *
+ * @return uint64_t: the next tick to visit, after the current one
+ */
+uint64_t TimingWheel::nextEvent() const {
+    unsigned int pos = now & SLOT_MASK;
+    if (occupied[0] != 0) {
+        uint64_t ahead = (pos == SLOT_MASK) ? 0 : occupied[0] & (~(uint64_t)0 << (pos + 1));
+        return now + ((ahead != 0) ? (uint64_t) __builtin_ctzll(ahead) - pos : SLOTS - pos);
+    }
+    uint64_t next = UINT64_MAX;
+    for (unsigned int l = 1; l < LEVELS; l++) {
+        if (occupied[l] == 0) {
+            continue;
+        }
+        uint64_t round = now >> (SLOT_BITS * l);
+        unsigned int idx = round & SLOT_MASK;
+        uint64_t ahead = (idx == SLOT_MASK) ? 0 : occupied[l] & (~(uint64_t)0 << (idx + 1));
+        // Rounds until the clock reaches the next occupied slot of this level, wrapping around if needed
+        uint64_t rounds = (ahead != 0) ? __builtin_ctzll(ahead) - idx : __builtin_ctzll(occupied[l]) + SLOTS - idx;
+        uint64_t at = (round + rounds) << (SLOT_BITS * l);
+        if (at < next) {
+            next = at;
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief Put a process to sleep until a timeout, in O(1). Its state becomes WAITING.
+ *
+ * @param pcb: the process
+ * @param delay: the number of ticks until it expires; 0 is treated as 1, the next tick
+ * @return Handle: a handle for cancel, or INVALID_HANDLE if the PCB is NULL
+ */
+TimingWheel::Handle TimingWheel::addTimer(PCB *pcb, uint64_t delay) {
+    if (pcb == NULL) {
+        cerr << "TimingWheel: cannot add a timer for a NULL PCB" << endl;
+        return INVALID_HANDLE;
+    }
+    if (freeList < 0) {
+        Node node = {NULL, -1, -1, 0, 0, 0};
+        nodes.push_back(node);
+        freeList = (int) nodes.size() - 1;
+    }
+    int n = freeList;
+    freeList = nodes[n].next;
+    nodes[n].pcb = pcb;
+    // The slot of the current tick has already been expired, so the earliest a timer can fire is the next one
+    nodes[n].expires = now + (delay == 0 ? 1 : delay);
+    place(n);
+    count++;
+    pcb->setState(ProcState::WAITING);
+    Handle h = {n, nodes[n].generation};
+    return h;
+}
+
+/**
+ * @brief Cancel a timer, in O(1). The PCB's state is left for the caller to set.
+ *
+ * @param h: the handle returned by addTimer
+ * @return PCB*: the PCB of the timer, or NULL if the handle is stale
+ */
+PCB* TimingWheel::cancel(Handle h) {
+    if (h.index < 0 || h.index >= (int) nodes.size() || nodes[h.index].slot == 0 ||
+        nodes[h.index].generation != h.generation) {
+        return NULL;
+    }
+    PCB *pcb = nodes[h.index].pcb;
+    unlink(h.index);
+    release(h.index);
+    return pcb;
+}
+
+/**
+ * @brief Advance the clock and move every process whose timer expires on the way into a ready queue.
+ * Ticks are not visited one by one: the occupancy bitmaps give the next tick at which a timer expires or
+ * an occupied slot cascades, and the clock jumps straight there.
+ *
+ * @param ticks: the number of ticks to advance
+ * @param queue: the ready queue that receives the expired processes
+ * @return int: the number of processes moved to the queue
+ */
+int TimingWheel::advance(uint64_t ticks, ReadyQueue &queue) {
+    expired.clear();
+    while (ticks > 0) {
+        if (count == 0) {
+            now += ticks;
+            break;
+        }
+        uint64_t step = nextEvent() - now;
+        if (step > ticks) {
+            now += ticks;
+            break;
+        }
+        now += step;
+        ticks -= step;
+        if ((now & SLOT_MASK) == 0) {
+            // Cascade from the highest level whose lower bits all wrapped, so timers can fall several levels
+            unsigned int top = 1;
+            while (top + 1 < LEVELS && ((now >> (SLOT_BITS * top)) & SLOT_MASK) == 0) {
+                top++;
+            }
+            for (unsigned int l = top; l >= 1; l--) {
+                cascade(l);
+            }
+        }
+        expireCurrent();
+    }
+    if (expired.empty()) {
+        return 0;
+    }
+    return queue.addPCBs(expired.data(), (int) expired.size());
+}
+
+/**
+ * @brief Get the current tick.
+ *
+ * @return uint64_t: the current tick
+ */
+uint64_t TimingWheel::getTime() {
+    return now;
+}
+
+/**
+ * @brief Returns the number of pending timers.
+ *
+ * @return int: the number of timers
+ */
+int TimingWheel::size() {
+    return count;
+}
@@ -0,0 +1,162 @@
+/**
+ * Assignment 1: priority queue of processes
+ * @file timingwheel.h
+ * @brief TimingWheel keeps WAITING processes with timeouts and moves them to a ReadyQueue when they expire.
+ * @version 0.1
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pcb.h"
+#include "readyqueue.h"
+
+/**
+ * @brief A hierarchical timing wheel of PCBs waiting for a timeout.
+ *
+ * Time is counted in ticks. The wheel has LEVELS levels of SLOTS slots each: level 0 holds timers due in
+ * the next SLOTS ticks, one slot per tick, and each level above covers SLOTS times the range of the one
+ * below. When level 0 wraps around, the matching slot of level 1 is emptied and its timers are spread over
+ * level 0, and likewise further up. A timer is moved at most LEVELS-1 times, so adding, cancelling and
+ * expiring a timer are O(1), whatever the number of timers. Timers further than the wheel's range are kept
+ * in the top level and placed again when it comes around.
+ *
+ * Each slot is a doubly linked list of nodes in a pool, so a timer can be cancelled in O(1) with the handle
+ * returned by addTimer. Each level has an occupancy bitmap, so advance skips empty ticks without visiting them.
+ */
+class TimingWheel {
+public:
+    // Number of levels and slots per level. The wheel covers SLOTS^LEVELS ticks without re-placing timers.
+    static const unsigned int LEVELS = 4;
+    static const unsigned int SLOT_BITS = 6;
+    static const unsigned int SLOTS = 1 << SLOT_BITS;
+
+    /**
+     * @brief Identifies one timer. Returned by addTimer and accepted by cancel.
+     * A handle becomes stale once its timer expires or is cancelled, and stale handles are rejected.
+     */
+    struct Handle {
+        // Index of the node in the pool, or -1 for a handle that never referred to a node
+        int index;
+        // Generation of the node when the handle was issued
+        unsigned int generation;
+    };
+
+    // Handle returned when a timer could not be added
+    static const Handle INVALID_HANDLE;
+
+private:
+    // A pending timer. Timers of one slot are doubly linked through indexes into the pool (-1 ends the chain).
+    struct Node {
+        PCB *pcb;
+        int prev;
+        int next;
+        // The absolute tick at which the timer expires
+        uint64_t expires;
+        // level * SLOTS + slot + 1 of the list holding the node, or 0 while the node is on the free list
+        unsigned int slot;
+        // Bumped every time the node is released, so handles to an earlier use of it become stale
+        unsigned int generation;
+    };
+
+    // Heads of the slot lists, indexed by level * SLOTS + slot (-1 when empty)
+    int heads[LEVELS * SLOTS];
+    // Bit s of occupied[l] is set if and only if slot s of level l is non-empty
+    uint64_t occupied[LEVELS];
+    // Node pool shared by all slots
+    std::vector<Node> nodes;
+    // Head of the chain of unused nodes in the pool (-1 when the pool is exhausted)
+    int freeList;
+    // Number of pending timers
+    int count;
+    // The current tick
+    uint64_t now;
+    // PCBs expired during the current advance, handed to the ready queue in one batch
+    std::vector<PCB *> expired;
+
+    /**
+     * @brief Link a node into the slot for its expiry time, relative to the current tick.
+     */
+    void place(int n);
+
+    /**
+     * @brief Unlink a node from its slot list.
+     */
+    void unlink(int n);
+
+    /**
+     * @brief Return a node to the free list and invalidate all handles to it.
+     */
+    void release(int n);
+
+    /**
+     * @brief Empty one slot of an upper level and place its timers again, closer to expiry.
+     */
+    void cascade(unsigned int level);
+
+    /**
+     * @brief Expire every timer of the level 0 slot of the current tick.
+     */
+    void expireCurrent();
+
+    /**
+     * @brief Find the next tick at which a timer expires or an occupied slot cascades.
+     */
+    uint64_t nextEvent() const;
+
+public:
+    /**
+     * @brief Construct a new TimingWheel object
+     *
+     * @param capacity: the number of timers to make room for up front; the pool grows beyond it as needed
+     * @param start: the tick the wheel starts at
+     */
+    TimingWheel(int capacity = 1024, uint64_t start = 0);
+
+    // Timers refer to their nodes by index, so copying the wheel is not supported
+    TimingWheel(const TimingWheel &) = delete;
+    TimingWheel &operator=(const TimingWheel &) = delete;
+
+    /**
+     * @brief Put a process to sleep until a timeout, in O(1). Its state becomes WAITING.
+     *
+     * @param pcb: the process
+     * @param delay: the number of ticks until it expires; 0 is treated as 1, the next tick
+     * @return Handle: a handle for cancel, or INVALID_HANDLE if the PCB is NULL
+     */
+    Handle addTimer(PCB *pcb, uint64_t delay);
+
+    /**
+     * @brief Cancel a timer, in O(1), for example when the event the process waits for arrives first.
+     * The PCB's state is left for the caller to set.
+     *
+     * @param h: the handle returned by addTimer
+     * @return PCB*: the PCB of the timer, or NULL if the handle is stale
+     */
+    PCB* cancel(Handle h);
+
+    /**
+     * @brief Advance the clock and move every process whose timer expires on the way into a ready queue, with
+     * one addPCBs call. Processes are added in order of expiry tick; those expiring on the same tick are added
+     * in no particular order.
+     *
+     * @param ticks: the number of ticks to advance
+     * @param queue: the ready queue that receives the expired processes
+     * @return int: the number of processes moved to the queue
+     */
+    int advance(uint64_t ticks, ReadyQueue &queue);
+
+    /**
+     * @brief Get the current tick.
+     *
+     * @return uint64_t: the number of ticks since the start, plus the start tick
+     */
+    uint64_t getTime();
+
+    /**
+     * @brief Returns the number of pending timers.
+     *
+     * @return int: the number of timers
+     */
+    int size();
+};
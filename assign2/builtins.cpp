@@ -0,0 +1,273 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file builtins.cpp
+ * @brief Commands the shell runs itself, without starting a process
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include "builtins.h"
+#include "pathcache.h"
+#include "jobs.h"
+#include "history.h"
+
+extern char **environ;
+
+int exit_requested = 0;
+int exit_status = 0;
+
+/**
+ * @brief cd [dir]: change the directory of the shell; without an argument go to HOME, with "-" to OLDPWD
+ */
+static int builtin_cd(int argc, char *argv[])
+{
+    const char *dir = (argc > 1) ? argv[1] : getenv("HOME");
+    if (argc > 1 && strcmp(argv[1], "-") == 0) {
+        dir = getenv("OLDPWD");
+    }
+    if (dir == NULL) {
+        fprintf(stderr, "cd: %s not set\n", argc > 1 ? "OLDPWD" : "HOME");
+        return 1;
+    }
+    char old[PATH_MAX];
+    if (getcwd(old, sizeof(old)) == NULL) {
+        old[0] = 0;
+    }
+    if (chdir(dir) < 0) {
+        perror("cd");
+        return 1;
+    }
+    char now[PATH_MAX];
+    if (getcwd(now, sizeof(now)) != NULL) {
+        setenv("PWD", now, 1);
+    }
+    setenv("OLDPWD", old, 1);
+    if (argc > 1 && strcmp(argv[1], "-") == 0) {
+        printf("%s\n", now);
+    }
+    return 0;
+}
+
+/**
+ * @brief pwd: print the directory of the shell
+ */
+static int builtin_pwd(int argc, char *argv[])
+{
+    char dir[PATH_MAX];
+    if (getcwd(dir, sizeof(dir)) == NULL) {
+        perror("pwd");
+        return 1;
+    }
+    printf("%s\n", dir);
+    return 0;
+}
+
+/**
+ * @brief echo [-n] [words]: print the words separated by spaces; -n leaves out the newline
+ */
+static int builtin_echo(int argc, char *argv[])
+{
+    int first = 1;
+    int newline = 1;
+    if (argc > 1 && strcmp(argv[1], "-n") == 0) {
+        newline = 0;
+        first = 2;
+    }
+    for (int i = first; i < argc; i++) {
+        fputs(argv[i], stdout);
+        if (i + 1 < argc) {
+            putchar(' ');
+        }
+    }
+    if (newline) {
+        putchar('\n');
+    }
+    return 0;
+}
+
+/**
+ * @brief export [NAME=value | NAME]...: set environment variables for the commands the shell starts;
+ * without arguments list the environment
+ */
+static int builtin_export(int argc, char *argv[])
+{
+    if (argc == 1) {
+        for (char **env = environ; *env != NULL; env++) {
+            printf("export %s\n", *env);
+        }
+        return 0;
+    }
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        char *equals = strchr(argv[i], '=');
+        if (equals == argv[i]) {
+            fprintf(stderr, "export: '%s': not a valid name\n", argv[i]);
+            status = 1;
+            continue;
+        }
+        if (equals == NULL) {
+            // Variables of the shell are already in its environment
+            continue;
+        }
+        *equals = 0;
+        setenv(argv[i], equals + 1, 1);
+        *equals = '=';
+    }
+    return status;
+}
+
+/**
+ * @brief true: do nothing, successfully
+ */
+static int builtin_true(int argc, char *argv[])
+{
+    return 0;
+}
+
+/**
+ * @brief false: do nothing, unsuccessfully
+ */
+static int builtin_false(int argc, char *argv[])
+{
+    return 1;
+}
+
+/**
+ * @brief exit [n]: stop the shell after this command, with status n (default 0)
+ */
+static int builtin_exit(int argc, char *argv[])
+{
+    exit_requested = 1;
+    exit_status = (argc > 1) ? atoi(argv[1]) & 0xff : 0;
+    return exit_status;
+}
+
+/**
+ * @brief hash [-r]: list the cached command paths, or forget them with -r
+ */
+static int builtin_hash(int argc, char *argv[])
+{
+    if (argc == 1) {
+        print_path_cache();
+    } else if (argc == 2 && strcmp(argv[1], "-r") == 0) {
+        clear_path_cache();
+    } else {
+        fprintf(stderr, "Usage: hash [-r]\n");
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief jobs: list the background jobs
+ */
+static int builtin_jobs(int argc, char *argv[])
+{
+    print_jobs();
+    return 0;
+}
+
+/**
+ * @brief fg [%n]: wait for a background job, by default the most recent one
+ */
+static int builtin_fg(int argc, char *argv[])
+{
+    int id = find_job(argc > 1 ? argv[1] : NULL);
+    if (id == 0) {
+        fprintf(stderr, "fg: no such job\n");
+        return 1;
+    }
+    print_job_command(id);
+    continue_job(id);
+    return wait_job(id);
+}
+
+/**
+ * @brief wait [%n]: wait for a background job, or for all of them
+ */
+static int builtin_wait(int argc, char *argv[])
+{
+    if (argc == 1) {
+        wait_all_jobs();
+        return 0;
+    }
+    int id = find_job(argv[1]);
+    if (id == 0) {
+        fprintf(stderr, "wait: no such job\n");
+        return 127;
+    }
+    return wait_job(id);
+}
+
+/**
+ * @brief history [n] | history -c: list the last n commands (default HISTORY_SIZE), or clear the history
+ */
+static int builtin_history(int argc, char *argv[])
+{
+    if (argc == 2 && strcmp(argv[1], "-c") == 0) {
+        clear_history();
+        return 0;
+    }
+    if (argc > 2 || (argc == 2 && atoll(argv[1]) <= 0)) {
+        fprintf(stderr, "Usage: history [n | -c]\n");
+        return 1;
+    }
+    print_history(argc == 2 ? strtoull(argv[1], NULL, 10) : HISTORY_SIZE);
+    return 0;
+}
+
+// Name and function of every builtin, and whether it works on the job table
+static const struct {
+    const char *name;
+    builtin_function function;
+    int job_control;
+} builtins[] = {
+    {"cd", builtin_cd, 0},
+    {"pwd", builtin_pwd, 0},
+    {"echo", builtin_echo, 0},
+    {"export", builtin_export, 0},
+    {"true", builtin_true, 0},
+    {"false", builtin_false, 0},
+    {"exit", builtin_exit, 0},
+    {"hash", builtin_hash, 0},
+    {"jobs", builtin_jobs, 1},
+    {"fg", builtin_fg, 1},
+    {"wait", builtin_wait, 1},
+    {"history", builtin_history, 0},
+};
+
+/**
+ * @brief Find a builtin by name
+ * 
+ * @param name Command name
+ * @return The builtin, or NULL if the command is not a builtin
+ */
+builtin_function find_builtin(const char *name)
+{
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++) {
+        if (strcmp(builtins[i].name, name) == 0) {
+            return builtins[i].function;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Check whether a command is a builtin that waits for or lists the jobs of the job table
+ * 
+ * @param name Command name
+ * @return 1 for jobs, fg and wait, 0 otherwise
+ */
+int is_job_control_builtin(const char *name)
+{
+    for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++) {
+        if (strcmp(builtins[i].name, name) == 0) {
+            return builtins[i].job_control;
+        }
+    }
+    return 0;
+}
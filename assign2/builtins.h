@@ -0,0 +1,36 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file builtins.h
+ * @brief Commands the shell runs itself, without starting a process
+ * @version 1.0
+ */
+#pragma once
+
+/**
+ * @brief A builtin command
+ * 
+ * @param argc Number of arguments, including the command name
+ * @param argv NULL-terminated arguments, after redirections have been removed
+ * @return Exit status of the command
+ */
+typedef int (*builtin_function)(int argc, char *argv[]);
+
+/**
+ * @brief Find a builtin by name
+ * 
+ * @param name Command name
+ * @return The builtin, or NULL if the command is not a builtin
+ */
+builtin_function find_builtin(const char *name);
+
+/**
+ * @brief Check whether a command is a builtin that waits for or lists the jobs of the job table
+ * 
+ * @param name Command name
+ * @return 1 for jobs, fg and wait, 0 otherwise
+ */
+int is_job_control_builtin(const char *name);
+
+// Set by the exit builtin: whether the shell should stop, and the status it should exit with
+extern int exit_requested;
+extern int exit_status;
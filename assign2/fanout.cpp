@@ -0,0 +1,214 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file fanout.cpp
+ * @brief Copying one pipe to several, for the fan-out operator |>
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <vector>
+#include "fanout.h"
+
+using namespace std;
+
+// Most bytes passed on at once: the default capacity of a pipe
+static const size_t FANOUT_CHUNK = 65536;
+
+/**
+ * @brief Write all of a buffer to an output, dropping the output if its reader has exited
+ *
+ * @param fd The output; set to -1 if it was dropped
+ * @param data The bytes to write
+ * @param length Number of bytes
+ * @return 0 on success or if the output was dropped, -1 on another error
+ */
+static int write_all(int *fd, const char *data, size_t length)
+{
+    while (length > 0) {
+        ssize_t n = write(*fd, data, length);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EPIPE) {
+            close(*fd);
+            *fd = -1;
+            return 0;
+        }
+        if (n < 0) {
+            perror("Fan-out write failed");
+            return -1;
+        }
+        data += n;
+        length -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Read a number of bytes, or up to end of input
+ *
+ * @param fd The input
+ * @param data Where to store the bytes
+ * @param length Number of bytes
+ * @return Number of bytes read, or -1 on error
+ */
+static ssize_t read_full(int fd, char *data, size_t length)
+{
+    size_t total = 0;
+    while (total < length) {
+        ssize_t n = read(fd, data + total, length - total);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            perror("Fan-out read failed");
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    return total;
+}
+
+/**
+ * @brief Copy everything read from a pipe to every one of several pipes, until end of input
+ *
+ * @param in_fd Read end of the input pipe
+ * @param out_fds Write ends of the output pipes
+ * @param count Number of outputs
+ * @return 0 at end of input or once every output is gone, -1 (after printing an error) on a read or
+ * write error
+ */
+int fan_out(int in_fd, const int out_fds[], int count)
+{
+    vector<int> outs(out_fds, out_fds + count);
+    vector<char> buffer(FANOUT_CHUNK);
+#ifdef __linux__
+    // Bytes of the current chunk tee() put into each output
+    vector<size_t> sent(count);
+    bool zero_copy = true;
+#endif
+    while (true) {
+        int last = -1;
+        for (int i = 0; i < count; i++) {
+            if (outs[i] >= 0) {
+                last = i;
+            }
+        }
+        if (last < 0) {
+            return 0;
+        }
+
+#ifdef __linux__
+        if (zero_copy) {
+            // Duplicate the data at the front of the input into every output but the last. The first tee()
+            // waits for data and sets the size n of the chunk; the others may fit less of it.
+            ssize_t n = -1;
+            bool shortfall = false;
+            for (int i = 0; i < last && zero_copy; i++) {
+                if (outs[i] < 0) {
+                    continue;
+                }
+                ssize_t m;
+                do {
+                    m = tee(in_fd, outs[i], (n < 0) ? FANOUT_CHUNK : n, 0);
+                } while (m < 0 && errno == EINTR);
+                if (m < 0 && errno == EPIPE) {
+                    close(outs[i]);
+                    outs[i] = -1;
+                    continue;
+                }
+                if (m < 0 && errno == EINVAL && n < 0) {
+                    // Not a pipe after all
+                    zero_copy = false;
+                    break;
+                }
+                if (m < 0) {
+                    perror("Fan-out tee failed");
+                    return -1;
+                }
+                if (n < 0) {
+                    if (m == 0) {
+                        return 0;
+                    }
+                    n = m;
+                }
+                sent[i] = m;
+                shortfall = shortfall || m < n;
+            }
+            if (!zero_copy) {
+                continue;
+            }
+
+            // Move the chunk into the last output, which makes room in the input for more. With no other
+            // output left, whatever is in the input is moved.
+            size_t moved = 0;
+            while (!shortfall && (n < 0 || moved < (size_t) n)) {
+                ssize_t m = splice(in_fd, NULL, outs[last], NULL, (n < 0) ? FANOUT_CHUNK : n - moved,
+                                   SPLICE_F_MOVE);
+                if (m < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (m < 0 && errno == EPIPE) {
+                    close(outs[last]);
+                    outs[last] = -1;
+                    break;
+                }
+                if (m < 0 && errno == EINVAL && n < 0) {
+                    zero_copy = false;
+                    break;
+                }
+                if (m < 0) {
+                    perror("Fan-out splice failed");
+                    return -1;
+                }
+                if (n < 0) {
+                    if (m == 0) {
+                        return 0;
+                    }
+                    break;
+                }
+                moved += m;
+            }
+
+            // The rest of the chunk goes through user space: the part tee() could not fit, and the part a
+            // last output that has exited did not take
+            if (n > 0 && moved < (size_t) n) {
+                if (read_full(in_fd, buffer.data(), n - moved) < 0) {
+                    return -1;
+                }
+                for (int i = 0; i <= last; i++) {
+                    size_t from = (i == last) ? moved : sent[i];
+                    if (outs[i] >= 0 && from < (size_t) n &&
+                        write_all(&outs[i], buffer.data() + from - moved, n - from) < 0) {
+                        return -1;
+                    }
+                }
+            }
+            continue;
+        }
+#endif
+
+        ssize_t n = read(in_fd, buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            perror("Fan-out read failed");
+            return -1;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        for (int i = 0; i <= last; i++) {
+            if (outs[i] >= 0 && write_all(&outs[i], buffer.data(), n) < 0) {
+                return -1;
+            }
+        }
+    }
+}
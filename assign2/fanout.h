@@ -0,0 +1,24 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file fanout.h
+ * @brief Copying one pipe to several, for the fan-out operator |>
+ * @version 1.0
+ */
+#pragma once
+
+/**
+ * @brief Copy everything read from a pipe to every one of several pipes, until end of input
+ *
+ * On Linux the data is duplicated with tee() and moved into the last output with splice(), so it is not
+ * copied through user space. It falls back to read() and write() on other systems, and for the part of a
+ * chunk that tee() could not fit into an output that was nearly full. An output whose reader has exited is
+ * dropped, and the others still get everything; once all are gone, the rest of the input is not read.
+ * SIGPIPE must be ignored by the caller.
+ *
+ * @param in_fd Read end of the input pipe
+ * @param out_fds Write ends of the output pipes
+ * @param count Number of outputs
+ * @return 0 at end of input or once every output is gone, -1 (after printing an error) on a read or
+ * write error
+ */
+int fan_out(int in_fd, const int out_fds[], int count);
@@ -0,0 +1,362 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file history.cpp
+ * @brief Command history kept in a memory-mapped file, so it survives restarts and is shared by shells
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "history.h"
+
+using namespace std;
+
+// Size of the rings of a new history file: a million entries and 64 MB of text. The file is sparse, so
+// only the part that has been written takes up disk space.
+static const uint64_t HISTORY_ENTRIES = 1 << 20;
+static const uint64_t HISTORY_BYTES = 64 << 20;
+
+// Largest rings accepted from an existing file, far above the defaults, so the size of the file can be
+// computed without overflow
+static const uint64_t MAX_HISTORY_ENTRIES = (uint64_t) 1 << 32;
+static const uint64_t MAX_HISTORY_BYTES = (uint64_t) 1 << 40;
+
+// Number of leading bytes of each entry kept in its slot, so prefix searches rarely read the text
+static const size_t HEAD_BYTES = 12;
+
+static const char HISTORY_MAGIC[8] = "OSHHIST";
+static const uint32_t HISTORY_VERSION = 1;
+
+// Start of the file. The slot ring follows it, then the text ring.
+struct history_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    // Number of slots and bytes of text in the rings
+    uint64_t capacity;
+    uint64_t data_size;
+    // Number of entries ever added; entry n is in slot (n - 1) % capacity
+    uint64_t count;
+    // Number of bytes of text ever written; byte p is at p % data_size in the text ring
+    uint64_t write_pos;
+};
+
+// One entry: where its text starts in the stream of all text written, and its first bytes
+struct history_slot {
+    uint64_t pos;
+    uint32_t length;
+    char head[HEAD_BYTES];
+};
+
+static history_header *header = NULL;
+static history_slot *slots = NULL;
+static char *text_ring = NULL;
+// Descriptor of the file, locked while it is changed, or -1 if history is only in memory
+static int history_fd = -1;
+
+/**
+ * @brief Lock the file against other shells, if there is one
+ * 
+ * @param operation LOCK_SH, LOCK_EX or LOCK_UN
+ */
+static void lock_history(int operation)
+{
+    if (history_fd >= 0) {
+        flock(history_fd, operation);
+    }
+}
+
+/**
+ * @brief Fill a new header
+ */
+static void init_header(history_header *h)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, HISTORY_MAGIC, sizeof(h->magic));
+    h->version = HISTORY_VERSION;
+    h->capacity = HISTORY_ENTRIES;
+    h->data_size = HISTORY_BYTES;
+}
+
+/**
+ * @brief Set the pointers to the rings of a mapping
+ */
+static void use_mapping(void *base)
+{
+    header = (history_header *) base;
+    slots = (history_slot *) (header + 1);
+    text_ring = (char *) (slots + header->capacity);
+}
+
+/**
+ * @brief Map history that is kept in memory only
+ */
+static void open_memory_history()
+{
+    history_header h;
+    init_header(&h);
+    size_t size = sizeof(h) + h.capacity * sizeof(history_slot) + h.data_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        perror("history: mmap failed");
+        return;
+    }
+    memcpy(base, &h, sizeof(h));
+    use_mapping(base);
+}
+
+/**
+ * @brief Open or create the history file and map it
+ * 
+ * @param path Path of the history file
+ * @return 1 if the file is in use, 0 if history is only in memory
+ */
+int open_history(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        perror("history: cannot open history file");
+        open_memory_history();
+        return 0;
+    }
+    flock(fd, LOCK_EX);
+    struct stat st;
+    history_header h;
+    if (fstat(fd, &st) < 0) {
+        st.st_size = 0;
+    }
+    if (st.st_size == 0) {
+        // A new file: write the header and make it the full size, without writing the rings
+        init_header(&h);
+        if (pwrite(fd, &h, sizeof(h), 0) != (ssize_t) sizeof(h) ||
+            ftruncate(fd, sizeof(h) + h.capacity * sizeof(history_slot) + h.data_size) < 0) {
+            st.st_size = -1;
+        }
+    } else if (pread(fd, &h, sizeof(h), 0) != (ssize_t) sizeof(h)) {
+        st.st_size = -1;
+    }
+    void *base = MAP_FAILED;
+    // The ring sizes are checked before the file size is computed from them
+    if (st.st_size >= 0 && memcmp(h.magic, HISTORY_MAGIC, sizeof(h.magic)) == 0 && h.version == HISTORY_VERSION &&
+        h.capacity > 0 && h.capacity <= MAX_HISTORY_ENTRIES && h.data_size > 0 && h.data_size <= MAX_HISTORY_BYTES) {
+        uint64_t size = sizeof(h) + h.capacity * sizeof(history_slot) + h.data_size;
+        fstat(fd, &st);
+        if ((uint64_t) st.st_size == size && size <= SIZE_MAX) {
+            base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+    }
+    flock(fd, LOCK_UN);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "history: %s is not a usable history file; history will not be saved\n", path);
+        close(fd);
+        open_memory_history();
+        return 0;
+    }
+    history_fd = fd;
+    use_mapping(base);
+    return 1;
+}
+
+/**
+ * @brief Append a command line to the history, in O(length of the line)
+ * 
+ * @param text The command line
+ */
+void add_history(const string &text)
+{
+    if (header == NULL || text.size() > header->data_size || text.size() > UINT32_MAX) {
+        return;
+    }
+    lock_history(LOCK_EX);
+    // Copy the text into the ring, in two pieces if it wraps around the end
+    uint64_t pos = header->write_pos;
+    size_t offset = pos % header->data_size;
+    size_t first = min(text.size(), (size_t) (header->data_size - offset));
+    memcpy(text_ring + offset, text.data(), first);
+    memcpy(text_ring, text.data() + first, text.size() - first);
+    
+    history_slot &slot = slots[header->count % header->capacity];
+    slot.pos = pos;
+    slot.length = (uint32_t) text.size();
+    memset(slot.head, 0, HEAD_BYTES);
+    memcpy(slot.head, text.data(), min(text.size(), HEAD_BYTES));
+    // Publish the entry last, so a reader never sees it half written
+    header->write_pos = pos + text.size();
+    header->count++;
+    lock_history(LOCK_UN);
+}
+
+/**
+ * @brief Number of the most recent entry; entries are numbered from 1 in the order they were added
+ * 
+ * @return The number, or 0 if the history is empty
+ */
+uint64_t history_count()
+{
+    return (header == NULL) ? 0 : header->count;
+}
+
+/**
+ * @brief The slot of an entry whose text has not been overwritten. The file must be locked.
+ * 
+ * @param n Entry number
+ * @return The slot, or NULL if the entry is no longer in the history
+ */
+static const history_slot *find_slot(uint64_t n)
+{
+    if (header == NULL || n == 0 || n > header->count || header->count - n >= header->capacity) {
+        return NULL;
+    }
+    const history_slot &slot = slots[(n - 1) % header->capacity];
+    // The file may have been damaged, so the text must lie within what was written, and its start must not
+    // have been overwritten since
+    if (slot.length > header->data_size || slot.pos > header->write_pos ||
+        header->write_pos - slot.pos < slot.length || header->write_pos - slot.pos > header->data_size) {
+        return NULL;
+    }
+    return &slot;
+}
+
+/**
+ * @brief Copy the text of an entry out of the ring. The file must be locked.
+ */
+static void copy_text(const history_slot &slot, string &text)
+{
+    size_t offset = slot.pos % header->data_size;
+    size_t first = min((size_t) slot.length, (size_t) (header->data_size - offset));
+    text.assign(text_ring + offset, first);
+    text.append(text_ring, slot.length - first);
+}
+
+/**
+ * @brief Get an entry by number, in O(length of the line)
+ * 
+ * @param n Entry number
+ * @param text Set to the command line
+ * @return 1 if the entry is still in the history, 0 otherwise
+ */
+int history_entry(uint64_t n, string &text)
+{
+    lock_history(LOCK_SH);
+    const history_slot *slot = find_slot(n);
+    if (slot != NULL) {
+        copy_text(*slot, text);
+    }
+    lock_history(LOCK_UN);
+    return slot != NULL;
+}
+
+/**
+ * @brief Find the most recent entry starting with a prefix
+ * 
+ * The search goes from the newest entry back and compares the first bytes kept in each slot, so the text
+ * ring is only read for prefixes longer than those and for the final match.
+ * 
+ * @param prefix The prefix
+ * @param text Set to the command line
+ * @return Number of the entry, or 0 if none matches
+ */
+uint64_t search_history(const string &prefix, string &text)
+{
+    if (header == NULL) {
+        return 0;
+    }
+    size_t head = min(prefix.size(), HEAD_BYTES);
+    uint64_t found = 0;
+    lock_history(LOCK_SH);
+    for (uint64_t n = header->count; n > 0 && found == 0; n--) {
+        const history_slot *slot = find_slot(n);
+        if (slot == NULL) {
+            break;
+        }
+        if (slot->length < prefix.size() || memcmp(slot->head, prefix.data(), head) != 0) {
+            continue;
+        }
+        copy_text(*slot, text);
+        if (text.compare(0, prefix.size(), prefix) == 0) {
+            found = n;
+        }
+    }
+    lock_history(LOCK_UN);
+    return found;
+}
+
+/**
+ * @brief Replace a history reference with the command it refers to
+ * 
+ * @param text The command line; replaced by the command if it is a history reference
+ * @return 1 if it was replaced, 0 if it is not a reference, -1 (after printing an error) if the entry does
+ * not exist
+ */
+int expand_history(string &text)
+{
+    if (text.size() < 2 || text[0] != '!' || text[1] == ' ' || text[1] == '\t') {
+        return 0;
+    }
+    uint64_t count = history_count();
+    string reference = text.substr(1);
+    string command;
+    int found;
+    if (reference == "!") {
+        if (count == 0) {
+            printf("No commands in history.\n");
+            return -1;
+        }
+        found = history_entry(count, command);
+    } else if (reference.find_first_not_of("0123456789") == string::npos ||
+               (reference[0] == '-' && reference.size() > 1 &&
+                reference.find_first_not_of("0123456789", 1) == string::npos)) {
+        // !n counts from the first entry, !-n back from the last
+        uint64_t n = strtoull(reference.c_str() + (reference[0] == '-'), NULL, 10);
+        if (reference[0] == '-') {
+            n = (n <= count) ? count + 1 - n : 0;
+        }
+        found = history_entry(n, command);
+    } else {
+        found = search_history(reference, command) != 0;
+    }
+    if (!found) {
+        printf("No such command in history.\n");
+        return -1;
+    }
+    text = command;
+    return 1;
+}
+
+/**
+ * @brief Print the last entries with their numbers (history [n])
+ * 
+ * @param n Number of entries to print
+ */
+void print_history(uint64_t n)
+{
+    uint64_t count = history_count();
+    uint64_t first = (n < count) ? count - n + 1 : 1;
+    string text;
+    for (uint64_t i = first; i <= count; i++) {
+        if (history_entry(i, text)) {
+            printf("%5llu  %s\n", (unsigned long long) i, text.c_str());
+        }
+    }
+}
+
+/**
+ * @brief Remove every entry (history -c)
+ */
+void clear_history()
+{
+    if (header == NULL) {
+        return;
+    }
+    lock_history(LOCK_EX);
+    header->count = 0;
+    header->write_pos = 0;
+    lock_history(LOCK_UN);
+}
@@ -0,0 +1,83 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file history.h
+ * @brief Command history kept in a memory-mapped file, so it survives restarts and is shared by shells
+ * @version 1.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// Number of entries the history builtin lists by default
+#define HISTORY_SIZE 10
+
+/**
+ * @brief Open or create the history file and map it
+ * 
+ * The file is a ring of entries and a ring of text. Mapping it costs the same whatever the number of
+ * entries, because nothing is read until it is used. If the file cannot be used, history is kept in memory
+ * for this session only.
+ * 
+ * @param path Path of the history file
+ * @return 1 if the file is in use, 0 if history is only in memory
+ */
+int open_history(const char *path);
+
+/**
+ * @brief Append a command line to the history, in O(length of the line)
+ * 
+ * The oldest entries are dropped once either ring is full. Lines longer than the text ring are not saved.
+ * 
+ * @param text The command line
+ */
+void add_history(const std::string &text);
+
+/**
+ * @brief Number of the most recent entry; entries are numbered from 1 in the order they were added
+ * 
+ * @return The number, or 0 if the history is empty
+ */
+uint64_t history_count();
+
+/**
+ * @brief Get an entry by number, in O(length of the line)
+ * 
+ * @param n Entry number
+ * @param text Set to the command line
+ * @return 1 if the entry is still in the history, 0 otherwise
+ */
+int history_entry(uint64_t n, std::string &text);
+
+/**
+ * @brief Find the most recent entry starting with a prefix
+ * 
+ * @param prefix The prefix
+ * @param text Set to the command line
+ * @return Number of the entry, or 0 if none matches
+ */
+uint64_t search_history(const std::string &prefix, std::string &text);
+
+/**
+ * @brief Replace a history reference with the command it refers to
+ * 
+ * "!!" is the last command, "!n" entry n, "!-n" the n-th last entry and "!prefix" the last command starting
+ * with prefix. Other lines are left alone.
+ * 
+ * @param text The command line; replaced by the command if it is a history reference
+ * @return 1 if it was replaced, 0 if it is not a reference, -1 (after printing an error) if the entry does
+ * not exist
+ */
+int expand_history(std::string &text);
+
+/**
+ * @brief Print the last entries with their numbers (history [n])
+ * 
+ * @param n Number of entries to print
+ */
+void print_history(uint64_t n);
+
+/**
+ * @brief Remove every entry (history -c)
+ */
+void clear_history();
@@ -0,0 +1,519 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file jobs.cpp
+ * @brief Table of the commands the shell has started, with children reaped as soon as they exit
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include "jobs.h"
+
+using namespace std;
+
+// One process of a job
+struct stage {
+    pid_t pid;
+    string name;
+    int running;
+    int status;
+    struct rusage usage;
+    // CLOCK_MONOTONIC time at which it was reaped
+    struct timespec ended;
+};
+
+// A command line started by the shell
+struct job {
+    int id;
+    string text;
+    vector<stage> stages;
+    int running;
+    int flags;
+    struct timespec started;
+};
+
+// A child collected by the SIGCHLD handler and not yet moved into the job table
+struct reaped_child {
+    pid_t pid;
+    int status;
+    struct rusage usage;
+    struct timespec ended;
+};
+
+static vector<job> jobs;
+
+// Filled by the signal handler and emptied by the shell with SIGCHLD blocked. When it is full the handler
+// stops reaping; the shell reaps the rest itself when it drains it.
+static const int MAX_REAPED = 256;
+static reaped_child reaped[MAX_REAPED];
+static volatile sig_atomic_t reaped_count = 0;
+
+static sigset_t sigchld_set;
+
+// Where finished jobs are logged, or NULL
+static FILE *job_log = NULL;
+
+/**
+ * @brief Collect every child that has exited, without blocking. Only calls async-signal-safe functions.
+ */
+static void reap_children()
+{
+    while (reaped_count < MAX_REAPED) {
+        reaped_child &child = reaped[reaped_count];
+        pid_t pid = wait4(-1, &child.status, WNOHANG, &child.usage);
+        if (pid <= 0) {
+            break;
+        }
+        child.pid = pid;
+        clock_gettime(CLOCK_MONOTONIC, &child.ended);
+        reaped_count = reaped_count + 1;
+    }
+}
+
+/**
+ * @brief SIGCHLD handler
+ */
+static void sigchld_handler(int sig)
+{
+    (void) sig;
+    int saved_errno = errno;
+    reap_children();
+    errno = saved_errno;
+}
+
+/**
+ * @brief Install the SIGCHLD handler that reaps children
+ */
+void init_jobs()
+{
+    sigemptyset(&sigchld_set);
+    sigaddset(&sigchld_set, SIGCHLD);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sigchld_handler;
+    sigemptyset(&action.sa_mask);
+    // Restart reads of the command line, and do not report children that are only stopped
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &action, NULL);
+}
+
+/**
+ * @brief Log the resource usage of every job, and of each of its stages, to a file when the job finishes
+ * 
+ * @param path File to append to
+ * @return 1 if the file was opened, 0 otherwise
+ */
+int set_job_log(const char *path)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0 || (job_log = fdopen(fd, "a")) == NULL) {
+        perror("Error opening job log");
+        return 0;
+    }
+    // One line per job and per stage, written out as each job finishes
+    setvbuf(job_log, NULL, _IOLBF, 0);
+    return 1;
+}
+
+/**
+ * @brief Seconds elapsed from one CLOCK_MONOTONIC time to another
+ */
+double seconds_between(const struct timespec &from, const struct timespec &to)
+{
+    return (to.tv_sec - from.tv_sec) + (to.tv_nsec - from.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Add the resource usage of one process to a total
+ */
+static void add_usage(struct rusage &total, const struct rusage &usage)
+{
+    timeradd(&total.ru_utime, &usage.ru_utime, &total.ru_utime);
+    timeradd(&total.ru_stime, &usage.ru_stime, &total.ru_stime);
+    if (usage.ru_maxrss > total.ru_maxrss) {
+        total.ru_maxrss = usage.ru_maxrss;
+    }
+    total.ru_nvcsw += usage.ru_nvcsw;
+    total.ru_nivcsw += usage.ru_nivcsw;
+}
+
+/**
+ * @brief Exit status of a job: that of its last stage, or 127 if the last stage could not be executed
+ */
+static int job_status(const job &jb)
+{
+    const stage &last = jb.stages.back();
+    return (last.pid < 0) ? 127 : last.status;
+}
+
+/**
+ * @brief Resource usage of all the processes of a job, and the time the last of them exited
+ */
+static void job_usage(const job &jb, struct rusage &total, struct timespec &ended)
+{
+    memset(&total, 0, sizeof(total));
+    ended = jb.started;
+    for (size_t k = 0; k < jb.stages.size(); k++) {
+        if (jb.stages[k].pid < 0) {
+            continue;
+        }
+        add_usage(total, jb.stages[k].usage);
+        if (seconds_between(ended, jb.stages[k].ended) > 0) {
+            ended = jb.stages[k].ended;
+        }
+    }
+}
+
+/**
+ * @brief Move the children collected by the handler into the job table. SIGCHLD must be blocked.
+ */
+static void drain_reaped()
+{
+    reap_children();
+    while (reaped_count > 0) {
+        for (int i = 0; i < reaped_count; i++) {
+            for (size_t j = 0; j < jobs.size(); j++) {
+                job &jb = jobs[j];
+                size_t k = 0;
+                while (k < jb.stages.size() && !(jb.stages[k].running && jb.stages[k].pid == reaped[i].pid)) {
+                    k++;
+                }
+                if (k == jb.stages.size()) {
+                    continue;
+                }
+                stage &st = jb.stages[k];
+                st.running = 0;
+                st.usage = reaped[i].usage;
+                st.ended = reaped[i].ended;
+                if (WIFSIGNALED(reaped[i].status)) {
+                    st.status = 128 + WTERMSIG(reaped[i].status);
+                } else {
+                    st.status = WEXITSTATUS(reaped[i].status);
+                }
+                jb.running--;
+                break;
+            }
+        }
+        reaped_count = 0;
+        // Children the handler left behind because the buffer was full
+        reap_children();
+    }
+}
+
+/**
+ * @brief Print one line of resource usage in the format of the time builtin
+ * 
+ * @param out Stream to print to
+ * @param label What the usage is of
+ * @param wall Elapsed seconds
+ * @param usage Resource usage
+ */
+void print_time_report(FILE *out, const char *label, double wall, const struct rusage &usage)
+{
+    fprintf(out, "%-12s real %.3f s  user %.3f s  sys %.3f s  max RSS %ld KB  ctx switches %ld/%ld\n", label,
+            wall, usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6,
+            usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6, usage.ru_maxrss, usage.ru_nvcsw,
+            usage.ru_nivcsw);
+}
+
+/**
+ * @brief Report a finished job as the time builtin and the job log ask, and remove it from the table
+ * 
+ * @param index Index of the job in the table
+ */
+static void finish_job(size_t index)
+{
+    const job &jb = jobs[index];
+    struct rusage total;
+    struct timespec ended;
+    job_usage(jb, total, ended);
+    double wall = seconds_between(jb.started, ended);
+    
+    if (jb.flags & JOB_TIMED) {
+        // Like the time of other shells, on standard error; a stage line per process of a pipeline
+        if (jb.stages.size() > 1) {
+            for (size_t k = 0; k < jb.stages.size(); k++) {
+                if (jb.stages[k].pid >= 0) {
+                    print_time_report(stderr, jb.stages[k].name.c_str(),
+                                      seconds_between(jb.started, jb.stages[k].ended), jb.stages[k].usage);
+                }
+            }
+        }
+        print_time_report(stderr, jb.stages.size() > 1 ? "total" : jb.stages[0].name.c_str(), wall, total);
+    }
+    if (job_log != NULL) {
+        fprintf(job_log, "job %d exit %d real %.6f user %.6f sys %.6f maxrss_kb %ld vcsw %ld ivcsw %ld cmd %s\n",
+                jb.id, job_status(jb), wall, total.ru_utime.tv_sec + total.ru_utime.tv_usec / 1e6,
+                total.ru_stime.tv_sec + total.ru_stime.tv_usec / 1e6, total.ru_maxrss, total.ru_nvcsw,
+                total.ru_nivcsw, jb.text.c_str());
+        for (size_t k = 0; k < jb.stages.size(); k++) {
+            const stage &st = jb.stages[k];
+            if (st.pid < 0) {
+                continue;
+            }
+            fprintf(job_log, "stage %d.%zu pid %d exit %d real %.6f user %.6f sys %.6f maxrss_kb %ld vcsw %ld "
+                    "ivcsw %ld cmd %s\n", jb.id, k + 1, (int) st.pid, st.status,
+                    seconds_between(jb.started, st.ended), st.usage.ru_utime.tv_sec + st.usage.ru_utime.tv_usec / 1e6,
+                    st.usage.ru_stime.tv_sec + st.usage.ru_stime.tv_usec / 1e6, st.usage.ru_maxrss,
+                    st.usage.ru_nvcsw, st.usage.ru_nivcsw, st.name.c_str());
+        }
+    }
+    jobs.erase(jobs.begin() + index);
+}
+
+/**
+ * @brief Index of a job in the table
+ * 
+ * @param id Job number
+ * @return Index, or -1 if there is no such job
+ */
+static int job_index(int id)
+{
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (jobs[i].id == id) {
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Add a started command line to the table
+ * 
+ * @param pids Process ID of each stage, or -1 for a stage that was not started
+ * @param names Command name of each stage
+ * @param count Number of stages
+ * @param text Command line, for jobs and the completion notice
+ * @param flags JOB_BACKGROUND and JOB_TIMED
+ * @param started CLOCK_MONOTONIC time at which the first stage was started
+ * @return Job number, or 0 if no stage was started
+ */
+int add_job(const pid_t pids[], char *const names[], int count, const char *text, int flags,
+            const struct timespec &started)
+{
+    job jb;
+    jb.id = 1;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (jobs[i].id >= jb.id) {
+            jb.id = jobs[i].id + 1;
+        }
+    }
+    jb.text = text;
+    jb.running = 0;
+    jb.flags = flags;
+    jb.started = started;
+    jb.stages.resize(count);
+    for (int i = 0; i < count; i++) {
+        stage &st = jb.stages[i];
+        st.pid = pids[i];
+        st.name = names[i];
+        st.running = (pids[i] >= 0);
+        st.status = 0;
+        memset(&st.usage, 0, sizeof(st.usage));
+        st.ended = started;
+        jb.running += st.running;
+    }
+    if (jb.running == 0) {
+        return 0;
+    }
+    
+    // The children may already have exited and been collected by the handler; they are matched to the job
+    // at the next drain, which is only possible once the job is in the table
+    sigset_t old_mask;
+    sigprocmask(SIG_BLOCK, &sigchld_set, &old_mask);
+    jobs.push_back(jb);
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    return jb.id;
+}
+
+/**
+ * @brief Wait until every process of a job has exited, and remove it from the table
+ * 
+ * @param id Job number
+ * @return Exit status of the last stage, as a shell reports it, or -1 if there is no such job
+ */
+int wait_job(int id)
+{
+    sigset_t old_mask;
+    sigprocmask(SIG_BLOCK, &sigchld_set, &old_mask);
+    int status = -1;
+    while (true) {
+        drain_reaped();
+        int i = job_index(id);
+        if (i < 0) {
+            break;
+        }
+        if (jobs[i].running == 0) {
+            status = job_status(jobs[i]);
+            finish_job(i);
+            break;
+        }
+        // Sleep until the next SIGCHLD; it cannot arrive between the check above and here
+        sigsuspend(&old_mask);
+    }
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    return status;
+}
+
+/**
+ * @brief Wait until any job has finished, and remove it from the table
+ * 
+ * @param status Set to the exit status of the job's last stage
+ * @param wall Set to the seconds from the start of the job to the exit of its last process
+ * @return Job number, or 0 if there are no jobs
+ */
+int wait_any_job(int *status, double *wall)
+{
+    sigset_t old_mask;
+    sigprocmask(SIG_BLOCK, &sigchld_set, &old_mask);
+    int id = 0;
+    while (!jobs.empty() && id == 0) {
+        drain_reaped();
+        for (size_t i = 0; i < jobs.size(); i++) {
+            if (jobs[i].running == 0) {
+                id = jobs[i].id;
+                *status = job_status(jobs[i]);
+                struct rusage total;
+                struct timespec ended;
+                job_usage(jobs[i], total, ended);
+                *wall = seconds_between(jobs[i].started, ended);
+                finish_job(i);
+                break;
+            }
+        }
+        if (id == 0) {
+            sigsuspend(&old_mask);
+        }
+    }
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    return id;
+}
+
+/**
+ * @brief Wait until every background job has exited, and remove them from the table
+ */
+void wait_all_jobs()
+{
+    while (!jobs.empty()) {
+        wait_job(jobs.front().id);
+    }
+}
+
+/**
+ * @brief Job number given as "%n" or "n", or the most recent background job if spec is NULL
+ * 
+ * @param spec Job specification, or NULL
+ * @return Job number, or 0 if there is no such job
+ */
+int find_job(const char *spec)
+{
+    if (spec == NULL) {
+        return jobs.empty() ? 0 : jobs.back().id;
+    }
+    if (spec[0] == '%') {
+        spec++;
+    }
+    int id = atoi(spec);
+    return (id > 0 && job_index(id) >= 0) ? id : 0;
+}
+
+/**
+ * @brief Print the command line of a job
+ * 
+ * @param id Job number
+ */
+void print_job_command(int id)
+{
+    int i = job_index(id);
+    if (i >= 0) {
+        printf("%s\n", jobs[i].text.c_str());
+    }
+}
+
+/**
+ * @brief Format the state of a job for jobs and the completion notice
+ */
+static string describe_job(const job &jb)
+{
+    char buffer[160];
+    if (jb.running > 0) {
+        snprintf(buffer, sizeof(buffer), "Running");
+    } else {
+        struct rusage total;
+        struct timespec ended;
+        job_usage(jb, total, ended);
+        snprintf(buffer, sizeof(buffer), "Done (exit %d, user %.3f s, sys %.3f s, max RSS %ld KB)", job_status(jb),
+                 total.ru_utime.tv_sec + total.ru_utime.tv_usec / 1e6,
+                 total.ru_stime.tv_sec + total.ru_stime.tv_usec / 1e6, total.ru_maxrss);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Print the background jobs that have finished since the last call, and remove them from the table
+ */
+void report_done_jobs()
+{
+    sigset_t old_mask;
+    sigprocmask(SIG_BLOCK, &sigchld_set, &old_mask);
+    drain_reaped();
+    for (size_t i = 0; i < jobs.size();) {
+        if ((jobs[i].flags & JOB_BACKGROUND) && jobs[i].running == 0) {
+            printf("[%d] %s\t%s\n", jobs[i].id, describe_job(jobs[i]).c_str(), jobs[i].text.c_str());
+            fflush(stdout);
+            finish_job(i);
+        } else {
+            i++;
+        }
+    }
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+}
+
+/**
+ * @brief Print every background job with its state, exit status and resource usage (jobs)
+ */
+void print_jobs()
+{
+    sigset_t old_mask;
+    sigprocmask(SIG_BLOCK, &sigchld_set, &old_mask);
+    drain_reaped();
+    for (size_t i = 0; i < jobs.size();) {
+        printf("[%d] %s\t%s\n", jobs[i].id, describe_job(jobs[i]).c_str(), jobs[i].text.c_str());
+        // A finished job has now been reported
+        if (jobs[i].running == 0) {
+            fflush(stdout);
+            finish_job(i);
+        } else {
+            i++;
+        }
+    }
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+}
+
+/**
+ * @brief Resume the processes of a job if they were stopped, with SIGCONT
+ * 
+ * @param id Job number
+ */
+void continue_job(int id)
+{
+    int i = job_index(id);
+    if (i < 0) {
+        return;
+    }
+    for (size_t k = 0; k < jobs[i].stages.size(); k++) {
+        if (jobs[i].stages[k].running) {
+            kill(jobs[i].stages[k].pid, SIGCONT);
+        }
+    }
+}
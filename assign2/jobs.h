@@ -0,0 +1,120 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file jobs.h
+ * @brief Table of the commands the shell has started, with children reaped as soon as they exit
+ * @version 1.0
+ */
+#pragma once
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+
+// Flags of add_job
+// The shell does not wait for the job
+#define JOB_BACKGROUND 1
+// Print the resource usage of the job and of each of its stages when it finishes (time)
+#define JOB_TIMED 2
+
+/**
+ * @brief Install the SIGCHLD handler that reaps children
+ * 
+ * The handler collects every child that has exited with wait4(WNOHANG), so no zombie outlives its command
+ * for longer than it takes the signal to arrive, even while the shell is blocked reading input. The exit
+ * statuses, resource usage and exit times it collects are moved into the job table at the next call to any
+ * of the functions below. Call this once before the first add_job.
+ */
+void init_jobs();
+
+/**
+ * @brief Log the resource usage of every job, and of each of its stages, to a file when the job finishes
+ * 
+ * @param path File to append to
+ * @return 1 if the file was opened, 0 otherwise
+ */
+int set_job_log(const char *path);
+
+/**
+ * @brief Add a started command line to the table
+ * 
+ * @param pids Process ID of each stage, or -1 for a stage that was not started
+ * @param names Command name of each stage
+ * @param count Number of stages
+ * @param text Command line, for jobs and the completion notice
+ * @param flags JOB_BACKGROUND and JOB_TIMED
+ * @param started CLOCK_MONOTONIC time at which the first stage was started
+ * @return Job number, or 0 if no stage was started
+ */
+int add_job(const pid_t pids[], char *const names[], int count, const char *text, int flags,
+            const struct timespec &started);
+
+/**
+ * @brief Wait until every process of a job has exited, and remove it from the table
+ * 
+ * @param id Job number
+ * @return Exit status of the last stage, as a shell reports it, or -1 if there is no such job
+ */
+int wait_job(int id);
+
+/**
+ * @brief Wait until any job has finished, and remove it from the table
+ * 
+ * @param status Set to the exit status of the job's last stage
+ * @param wall Set to the seconds from the start of the job to the exit of its last process
+ * @return Job number, or 0 if there are no jobs
+ */
+int wait_any_job(int *status, double *wall);
+
+/**
+ * @brief Wait until every background job has exited, and remove them from the table
+ */
+void wait_all_jobs();
+
+/**
+ * @brief Job number given as "%n" or "n", or the most recent background job if spec is NULL
+ * 
+ * @param spec Job specification, or NULL
+ * @return Job number, or 0 if there is no such job
+ */
+int find_job(const char *spec);
+
+/**
+ * @brief Print the command line of a job
+ * 
+ * @param id Job number
+ */
+void print_job_command(int id);
+
+/**
+ * @brief Print the background jobs that have finished since the last call, and remove them from the table
+ */
+void report_done_jobs();
+
+/**
+ * @brief Print every background job with its state, exit status and resource usage (jobs). Finished jobs are
+ * removed from the table once listed.
+ */
+void print_jobs();
+
+/**
+ * @brief Resume the processes of a job if they were stopped, with SIGCONT
+ * 
+ * @param id Job number
+ */
+void continue_job(int id);
+
+/**
+ * @brief Print one line of resource usage in the format of the time builtin
+ * 
+ * @param out Stream to print to
+ * @param label What the usage is of
+ * @param wall Elapsed seconds
+ * @param usage Resource usage
+ */
+void print_time_report(FILE *out, const char *label, double wall, const struct rusage &usage);
+
+/**
+ * @brief Seconds elapsed from one CLOCK_MONOTONIC time to another
+ */
+double seconds_between(const struct timespec &from, const struct timespec &to);
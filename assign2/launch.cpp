@@ -0,0 +1,204 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file launch.cpp
+ * @brief Starting a command in a child process, with either fork()+execv() or posix_spawn()
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <spawn.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <string>
+#include "launch.h"
+#include "pathcache.h"
+
+extern char **environ;
+
+/**
+ * @brief Parse the name of a backend
+ * 
+ * @param name "fork" or "spawn"
+ * @param backend Set to the backend named
+ * @return 1 if the name is known, 0 otherwise
+ */
+int parse_backend(const char *name, launch_backend *backend)
+{
+    if (strcmp(name, "fork") == 0) {
+        *backend = LAUNCH_FORK;
+        return 1;
+    }
+    if (strcmp(name, "spawn") == 0) {
+        *backend = LAUNCH_SPAWN;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Name of a backend, as accepted by parse_backend
+ * 
+ * @param backend The backend
+ * @return "fork" or "spawn"
+ */
+const char *backend_name(launch_backend backend)
+{
+    return backend == LAUNCH_FORK ? "fork" : "spawn";
+}
+
+/**
+ * @brief Fork a child that runs one path with execv()
+ * 
+ * The child holds the write end of a close-on-exec pipe. A successful exec closes it, so the shell reads
+ * end of file; a failed one writes its errno there first and exits with status 127.
+ * 
+ * @param path Path of the program
+ * @param args NULL-terminated command and arguments
+ * @param in_fd Descriptor to use as standard input, or -1
+ * @param out_fd Descriptor to use as standard output, or -1
+ * @param error Set to the errno of a failed exec, 0 if the exec succeeded
+ * @return Process ID of the child, or -1 if it could not be forked or its exec failed
+ */
+static pid_t fork_exec(const char *path, char *args[], int in_fd, int out_fd, int *error)
+{
+    *error = 0;
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) < 0) {
+        perror("Pipe creation failed");
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("Fork failed");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // Child process
+        if (in_fd >= 0) {
+            dup2(in_fd, STDIN_FILENO);
+        }
+        if (out_fd >= 0) {
+            dup2(out_fd, STDOUT_FILENO);
+        }
+        execv(path, args);
+        int err = errno;
+        ssize_t written = write(fds[1], &err, sizeof(err));
+        (void) written;
+        _exit(127);
+    }
+    close(fds[1]);
+    ssize_t n;
+    do {
+        n = read(fds[0], error, sizeof(*error));
+    } while (n < 0 && errno == EINTR);
+    close(fds[0]);
+    if (n != (ssize_t) sizeof(*error)) {
+        *error = 0;
+        return pid;
+    }
+    // The child has exited or is about to; if the SIGCHLD handler has reaped it already, this fails harmlessly
+    waitpid(pid, NULL, 0);
+    return -1;
+}
+
+/**
+ * @brief Start a command with fork() and execv()
+ * 
+ * The child reports a failed exec back to the shell, so as with posix_spawn the cached entry is dropped
+ * and the command is looked up in PATH once more, in case it has moved.
+ * 
+ * @param path Resolved path of the command
+ * @param args NULL-terminated command and arguments
+ * @param in_fd Descriptor to use as standard input, or -1
+ * @param out_fd Descriptor to use as standard output, or -1
+ * @return Process ID of the child, or -1 if it could not be started
+ */
+static pid_t launch_fork(const char *path, char *args[], int in_fd, int out_fd)
+{
+    int err;
+    pid_t pid = fork_exec(path, args, in_fd, out_fd, &err);
+    if (err != 0 && path != args[0]) {
+        std::string failed = path;
+        forget_command(args[0]);
+        path = resolve_command(args[0]);
+        if (path != NULL && failed != path) {
+            pid = fork_exec(path, args, in_fd, out_fd, &err);
+        }
+    }
+    if (err != 0) {
+        fprintf(stderr, "Command execution failed: %s\n", strerror(err));
+        return -1;
+    }
+    return pid;
+}
+
+/**
+ * @brief Start a command with posix_spawn(), expressing the redirections as file actions
+ * 
+ * If the cached path cannot be executed, the entry is dropped and the command is looked up in PATH once
+ * more, in case it has moved.
+ * 
+ * @param path Resolved path of the command
+ * @param args NULL-terminated command and arguments
+ * @param in_fd Descriptor to use as standard input, or -1
+ * @param out_fd Descriptor to use as standard output, or -1
+ * @return Process ID of the child, or -1 if it could not be started
+ */
+static pid_t launch_spawn(const char *path, char *args[], int in_fd, int out_fd)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (in_fd >= 0) {
+        posix_spawn_file_actions_adddup2(&actions, in_fd, STDIN_FILENO);
+    }
+    if (out_fd >= 0) {
+        posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+    }
+    
+    pid_t pid;
+    int err = posix_spawn(&pid, path, &actions, NULL, args, environ);
+    if (err != 0 && path != args[0]) {
+        std::string failed = path;
+        forget_command(args[0]);
+        path = resolve_command(args[0]);
+        if (path != NULL && failed != path) {
+            err = posix_spawn(&pid, path, &actions, NULL, args, environ);
+        }
+    }
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) {
+        fprintf(stderr, "Command execution failed: %s\n", strerror(err));
+        return -1;
+    }
+    return pid;
+}
+
+/**
+ * @brief Start a command in a child process with its standard input and output redirected
+ * 
+ * @param args NULL-terminated command and arguments; the command is looked up in PATH through the cache
+ * @param in_fd Descriptor to use as standard input, or -1 to inherit the shell's
+ * @param out_fd Descriptor to use as standard output, or -1 to inherit the shell's
+ * @param backend How to start the child
+ * @return Process ID of the child, or -1 if it could not be started
+ */
+pid_t launch_command(char *args[], int in_fd, int out_fd, launch_backend backend)
+{
+    // Anything buffered would otherwise be written twice, by the shell and by a forked child
+    fflush(stdout);
+    const char *path = resolve_command(args[0]);
+    if (path == NULL) {
+        fprintf(stderr, "Command execution failed: %s\n", strerror(ENOENT));
+        return -1;
+    }
+    if (backend == LAUNCH_FORK) {
+        return launch_fork(path, args, in_fd, out_fd);
+    }
+    return launch_spawn(path, args, in_fd, out_fd);
+}
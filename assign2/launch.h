@@ -0,0 +1,52 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file launch.h
+ * @brief Starting a command in a child process, with either fork()+execv() or posix_spawn()
+ * @version 1.0
+ */
+#pragma once
+
+#include <sys/types.h>
+
+/**
+ * @brief How a command is started
+ * 
+ * LAUNCH_FORK copies the shell with fork() and calls execv() in the child. LAUNCH_SPAWN uses
+ * posix_spawn(), which glibc implements with a vfork-style clone that shares the shell's memory until the
+ * exec, so it does not copy the page tables and its cost does not grow with the size of the shell.
+ */
+enum launch_backend {
+    LAUNCH_FORK,
+    LAUNCH_SPAWN
+};
+
+/**
+ * @brief Parse the name of a backend
+ * 
+ * @param name "fork" or "spawn"
+ * @param backend Set to the backend named
+ * @return 1 if the name is known, 0 otherwise
+ */
+int parse_backend(const char *name, launch_backend *backend);
+
+/**
+ * @brief Name of a backend, as accepted by parse_backend
+ * 
+ * @param backend The backend
+ * @return "fork" or "spawn"
+ */
+const char *backend_name(launch_backend backend);
+
+/**
+ * @brief Start a command in a child process with its standard input and output redirected
+ * 
+ * The descriptors the shell opens for redirection and pipes are close-on-exec, so the child only keeps the
+ * ones dup'ed onto its standard input and output here.
+ * 
+ * @param args NULL-terminated command and arguments; the command is looked up in PATH through the cache
+ * @param in_fd Descriptor to use as standard input, or -1 to inherit the shell's
+ * @param out_fd Descriptor to use as standard output, or -1 to inherit the shell's
+ * @param backend How to start the child
+ * @return Process ID of the child, or -1 if it could not be started
+ */
+pid_t launch_command(char *args[], int in_fd, int out_fd, launch_backend backend);
@@ -0,0 +1,124 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file pathcache.cpp
+ * @brief Cache of the absolute paths of commands found in PATH, like the hash builtin of bash
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <unordered_map>
+#include "pathcache.h"
+
+using namespace std;
+
+// A resolved command and the number of times it has been run from the cache
+struct path_entry {
+    string path;
+    unsigned long hits;
+};
+
+// Command name -> resolved path
+static unordered_map<string, path_entry> path_cache;
+// The value of PATH the cache was filled with
+static string cached_path_env;
+
+/**
+ * @brief Search the directories of PATH for an executable regular file
+ * 
+ * @param name Command name without '/'
+ * @param path_env Value of PATH
+ * @param result Set to the path found
+ * @return 1 if found, 0 otherwise
+ */
+static int search_path(const char *name, const char *path_env, string &result)
+{
+    const char *dir = path_env;
+    while (true) {
+        const char *end = strchr(dir, ':');
+        size_t len = (end == NULL) ? strlen(dir) : (size_t) (end - dir);
+        // An empty entry means the current directory
+        string candidate = (len == 0) ? string(".") : string(dir, len);
+        candidate += '/';
+        candidate += name;
+        struct stat st;
+        if (stat(candidate.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(candidate.c_str(), X_OK) == 0) {
+            result = candidate;
+            return 1;
+        }
+        if (end == NULL) {
+            return 0;
+        }
+        dir = end + 1;
+    }
+}
+
+/**
+ * @brief Find the executable a command name refers to
+ * 
+ * @param name Command name as typed
+ * @return Path to execute, valid until the cache changes, or NULL if the command was not found in PATH
+ */
+const char *resolve_command(const char *name)
+{
+    if (strchr(name, '/') != NULL) {
+        return name;
+    }
+    const char *path_env = getenv("PATH");
+    if (path_env == NULL) {
+        // The same default execvp uses
+        path_env = "/bin:/usr/bin";
+    }
+    if (cached_path_env != path_env) {
+        path_cache.clear();
+        cached_path_env = path_env;
+    }
+    
+    unordered_map<string, path_entry>::iterator it = path_cache.find(name);
+    if (it == path_cache.end()) {
+        string found;
+        if (!search_path(name, path_env, found)) {
+            return NULL;
+        }
+        it = path_cache.insert(make_pair(string(name), path_entry{found, 0})).first;
+    }
+    it->second.hits++;
+    return it->second.path.c_str();
+}
+
+/**
+ * @brief Drop the cached path of a command
+ * 
+ * @param name Command name as typed
+ */
+void forget_command(const char *name)
+{
+    path_cache.erase(name);
+}
+
+/**
+ * @brief Empty the cache (hash -r)
+ */
+void clear_path_cache()
+{
+    path_cache.clear();
+}
+
+/**
+ * @brief Print the cached commands with the number of times each was used (hash)
+ */
+void print_path_cache()
+{
+    if (path_cache.empty()) {
+        printf("hash: hash table empty\n");
+        return;
+    }
+    printf("hits\tcommand\n");
+    for (unordered_map<string, path_entry>::iterator it = path_cache.begin(); it != path_cache.end(); ++it) {
+        printf("%4lu\t%s\n", it->second.hits, it->second.path.c_str());
+    }
+}
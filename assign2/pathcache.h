@@ -0,0 +1,36 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file pathcache.h
+ * @brief Cache of the absolute paths of commands found in PATH, like the hash builtin of bash
+ * @version 1.0
+ */
+#pragma once
+
+/**
+ * @brief Find the executable a command name refers to
+ * 
+ * A name containing '/' is used as it is. Any other name is looked up in the cache, and on a miss each
+ * directory of PATH is searched in order and the result is cached. The cache is emptied whenever PATH has
+ * changed since it was filled.
+ * 
+ * @param name Command name as typed
+ * @return Path to execute, valid until the cache changes, or NULL if the command was not found in PATH
+ */
+const char *resolve_command(const char *name);
+
+/**
+ * @brief Drop the cached path of a command, for example because executing it failed
+ * 
+ * @param name Command name as typed
+ */
+void forget_command(const char *name);
+
+/**
+ * @brief Empty the cache (hash -r)
+ */
+void clear_path_cache();
+
+/**
+ * @brief Print the cached commands with the number of times each was used (hash)
+ */
+void print_path_cache();
@@ -13,53 +13,54 @@
 #include <fcntl.h>
 #include <cstring>
 #include <sys/wait.h>
+#include <sys/time.h>
+#include <signal.h>
 #include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "launch.h"
+#include "pathcache.h"
+#include "jobs.h"
+#include "builtins.h"
+#include "tokenizer.h"
+#include "history.h"
+#include "fanout.h"
 
 using namespace std;
 
-#define MAX_LINE 80
-#define HISTORY_SIZE 10
+// How commands are started; set with -b on the command line
+launch_backend backend = LAUNCH_SPAWN;
 
 /**
- * @brief Parse the command and arguments from input, handling special operators
+ * @brief Check if command should run in background (ends with &)
  * 
- * @param command The input command string
- * @param args Array to store parsed arguments
- * @return Number of arguments parsed
+ * @param args Array of command arguments
+ * @param arg_count Number of arguments
+ * @return 1 if background, 0 otherwise
  */
-int parse_command(char command[], char *args[])
+int check_background(char *args[], int *arg_count)
 {
-    int arg_count = 0;
-    char *token;
-    
-    // Remove trailing newline if present
-    command[strcspn(command, "\n")] = 0;
-    
-    // Tokenize the command by spaces
-    token = strtok(command, " ");
-    
-    while (token != NULL && arg_count < MAX_LINE / 2) {
-        args[arg_count++] = token;
-        token = strtok(NULL, " ");
+    if (*arg_count > 0 && args[*arg_count - 1] == OP_BACKGROUND) {
+        args[*arg_count - 1] = NULL;
+        (*arg_count)--;
+        return 1;
     }
-    
-    // NULL-terminate the argument array for execvp
-    args[arg_count] = NULL;
-    
-    return arg_count;
+    return 0;
 }
 
 /**
- * @brief Check if command should run in background (ends with &)
+ * @brief Check if command is prefixed with time, and remove the prefix
  * 
  * @param args Array of command arguments
- * @param arg_count Number of arguments
- * @return 1 if background, 0 otherwise
+ * @param arg_count Pointer to number of arguments
+ * @return 1 if timed, 0 otherwise
  */
-int check_background(char *args[], int *arg_count)
+int check_time_prefix(char *args[], int *arg_count)
 {
-    if (*arg_count > 0 && strcmp(args[*arg_count - 1], "&") == 0) {
-        args[*arg_count - 1] = NULL;
+    if (*arg_count > 1 && strcmp(args[0], "time") == 0) {
+        memmove(args, args + 1, *arg_count * sizeof(args[0]));
         (*arg_count)--;
         return 1;
     }
@@ -76,10 +77,10 @@ int check_background(char *args[], int *arg_count)
 int check_input_redirection(char *args[], int *arg_count)
 {
     for (int i = 0; i < *arg_count; i++) {
-        if (args[i] != NULL && strcmp(args[i], "<") == 0) {
+        if (args[i] == OP_INPUT) {
             if (i + 1 < *arg_count && args[i + 1] != NULL) {
                 char *input_file = args[i + 1];
-                int fd = open(input_file, O_RDONLY);
+                int fd = open(input_file, O_RDONLY | O_CLOEXEC);
                 if (fd < 0) {
                     perror("Error opening input file");
                     return -2;
@@ -107,17 +108,17 @@ int check_input_redirection(char *args[], int *arg_count)
 int check_output_redirection(char *args[], int *arg_count)
 {
     for (int i = 0; i < *arg_count; i++) {
-        if (args[i] != NULL && (strcmp(args[i], ">") == 0 || strcmp(args[i], ">>") == 0)) {
+        if (args[i] == OP_OUTPUT || args[i] == OP_APPEND) {
             if (i + 1 < *arg_count && args[i + 1] != NULL) {
                 char *output_file = args[i + 1];
                 int fd;
                 
-                if (strcmp(args[i], ">>") == 0) {
+                if (args[i] == OP_APPEND) {
                     // Append mode
-                    fd = open(output_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+                    fd = open(output_file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
                 } else {
                     // Truncate mode
-                    fd = open(output_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                    fd = open(output_file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
                 }
                 
                 if (fd < 0) {
@@ -138,16 +139,16 @@ int check_output_redirection(char *args[], int *arg_count)
 }
 
 /**
- * @brief Check if command contains a pipe (|)
+ * @brief Check if command contains a pipe (|), a fan-out (|>) or a process substitution (<(...))
  * 
  * @param args Array of command arguments
  * @param arg_count Number of arguments
- * @return Index of pipe symbol, or -1 if no pipe
+ * @return Index of the first of them, or -1 if there is none
  */
 int check_pipe(char *args[], int arg_count)
 {
     for (int i = 0; i < arg_count; i++) {
-        if (strcmp(args[i], "|") == 0) {
+        if (args[i] == OP_PIPE || args[i] == OP_FANOUT || args[i] == OP_SUBSTITUTE) {
             return i;
         }
     }
@@ -155,155 +156,631 @@ int check_pipe(char *args[], int arg_count)
 }
 
 /**
- * @brief Execute a simple command with optional I/O redirection
+ * @brief Find the ) that closes a process substitution
  * 
- * @param args Command arguments
+ * @param args Array of command arguments
+ * @param i Index of the <(
  * @param arg_count Number of arguments
+ * @return Index of the matching ), or arg_count if it is missing
  */
-void execute_simple_command(char *args[], int arg_count)
+int skip_substitution(char *args[], int i, int arg_count)
 {
-    if (arg_count == 0 || args[0] == NULL) {
-        return;
+    int nested = 0;
+    for (; i < arg_count; i++) {
+        if (args[i] == OP_SUBSTITUTE) {
+            nested++;
+        } else if (args[i] == OP_SUBSTITUTE_END && --nested == 0) {
+            return i;
+        }
     }
-    
-    int background = check_background(args, &arg_count);
+    return arg_count;
+}
+
+/**
+ * @brief Start a simple command with optional I/O redirection, without waiting for it
+ * 
+ * @param args Command arguments
+ * @param arg_count Number of arguments
+ * @return Process ID of the child, -1 if it could not be started, or -2 if its redirection failed
+ */
+pid_t start_simple_command(char *args[], int arg_count)
+{
     int input_fd = check_input_redirection(args, &arg_count);
     int output_fd = check_output_redirection(args, &arg_count);
     
     // Check for errors in file operations
     if (input_fd == -2 || output_fd == -2) {
-        return;
+        if (input_fd >= 0) close(input_fd);
+        if (output_fd >= 0) close(output_fd);
+        return -2;
     }
     
-    pid_t pid = fork();
+    pid_t pid = launch_command(args, input_fd, output_fd, backend);
     
-    if (pid < 0) {
-        perror("Fork failed");
+    // Parent process
+    if (input_fd >= 0) close(input_fd);
+    if (output_fd >= 0) close(output_fd);
+    return pid;
+}
+
+/**
+ * @brief Run a builtin in the shell process, with its standard input and output redirected while it runs
+ * 
+ * @param builtin The builtin
+ * @param args Command arguments
+ * @param arg_count Number of arguments
+ * @param timed 1 to print the time and resources the builtin used, as the shell measures them
+ * @return Exit status of the builtin, or 1 if the redirection failed
+ */
+int execute_builtin(builtin_function builtin, char *args[], int arg_count, int timed)
+{
+    struct timespec started, ended;
+    struct rusage before, after;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    getrusage(RUSAGE_SELF, &before);
+
+    int input_fd = check_input_redirection(args, &arg_count);
+    int output_fd = check_output_redirection(args, &arg_count);
+    if (input_fd == -2 || output_fd == -2) {
+        if (input_fd >= 0) close(input_fd);
+        if (output_fd >= 0) close(output_fd);
+        return 1;
+    }
+    
+    // Point the shell's own standard input and output at the files, keeping close-on-exec copies of the
+    // originals to put back afterwards
+    fflush(stdout);
+    int saved_in = -1, saved_out = -1;
+    if (input_fd >= 0) {
+        saved_in = fcntl(STDIN_FILENO, F_DUPFD_CLOEXEC, 10);
+        dup2(input_fd, STDIN_FILENO);
+        close(input_fd);
+    }
+    if (output_fd >= 0) {
+        saved_out = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 10);
+        dup2(output_fd, STDOUT_FILENO);
+        close(output_fd);
+    }
+    
+    int status = builtin(arg_count, args);
+    
+    fflush(stdout);
+    if (timed) {
+        clock_gettime(CLOCK_MONOTONIC, &ended);
+        getrusage(RUSAGE_SELF, &after);
+        // The shell's usage over the builtin; its maximum RSS is that of the shell so far
+        timersub(&after.ru_utime, &before.ru_utime, &after.ru_utime);
+        timersub(&after.ru_stime, &before.ru_stime, &after.ru_stime);
+        after.ru_nvcsw -= before.ru_nvcsw;
+        after.ru_nivcsw -= before.ru_nivcsw;
+        print_time_report(stderr, args[0], seconds_between(started, ended), after);
+    }
+    if (saved_in >= 0) {
+        dup2(saved_in, STDIN_FILENO);
+        close(saved_in);
+    }
+    if (saved_out >= 0) {
+        dup2(saved_out, STDOUT_FILENO);
+        close(saved_out);
+    }
+    return status;
+}
+
+/**
+ * @brief Add started processes to the job table, and wait for them unless they run in the background
+ * 
+ * @param pids Process ID of each stage, or -1 for a stage that was not started
+ * @param names Command name of each stage
+ * @param count Number of stages
+ * @param text The command line
+ * @param flags JOB_BACKGROUND if the shell should not wait, JOB_TIMED to report the resources used
+ * @param started When the first stage was started
+ */
+void run_job(const pid_t pids[], char *const names[], int count, const char *text, int flags,
+             const struct timespec &started)
+{
+    int id = add_job(pids, names, count, text, flags, started);
+    if (id == 0) {
         return;
     }
-    else if (pid == 0) {
-        // Child process
-        
-        // Set up input redirection
-        if (input_fd >= 0) {
-            dup2(input_fd, STDIN_FILENO);
-            close(input_fd);
-        }
-        
-        // Set up output redirection
-        if (output_fd >= 0) {
-            dup2(output_fd, STDOUT_FILENO);
-            close(output_fd);
-        }
-        
-        // Execute the command
-        if (execvp(args[0], args) < 0) {
-            perror("Command execution failed");
-            exit(1);
-        }
+    if (!(flags & JOB_BACKGROUND)) {
+        // Wait for the children to complete; the SIGCHLD handler reaps them
+        wait_job(id);
+    } else {
+        printf("[%d] Process %d running in background\n", id, pids[count - 1]);
     }
-    else {
-        // Parent process
-        if (input_fd >= 0) close(input_fd);
-        if (output_fd >= 0) close(output_fd);
-        
-        if (!background) {
-            // Wait for child to complete
-            int status;
-            waitpid(pid, &status, 0);
-        } else {
-            printf("[Process %d running in background]\n", pid);
-        }
+}
+
+/**
+ * @brief Execute a simple command with optional I/O redirection
+ * 
+ * @param args Command arguments
+ * @param arg_count Number of arguments
+ * @param text The command line, for the job table
+ * @param timed 1 to report the resources the command used
+ */
+void execute_simple_command(char *args[], int arg_count, const char *text, int timed)
+{
+    if (arg_count == 0 || args[0] == NULL) {
+        return;
+    }
+    
+    int background = check_background(args, &arg_count);
+    if (arg_count == 0) {
+        return;
     }
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    pid_t pid = start_simple_command(args, arg_count);
+    run_job(&pid, args, 1, text, (background ? JOB_BACKGROUND : 0) | (timed ? JOB_TIMED : 0), started);
 }
 
+// A process substitution of a pipeline stage: the read end of the pipe from its command, passed to the
+// stage as /dev/fd/N
+struct substitution {
+    int stage;
+    int fd;
+    char path[24];
+};
+
 /**
- * @brief Execute a piped command (cmd1 | cmd2)
+ * @brief Start a pipeline of any number of commands (cmd1 | cmd2 | ... | cmdN), without waiting for it
+ * 
+ * The stages are split in place by replacing each "|" with NULL. The children are started left to right,
+ * each with one new pipe to its right neighbour, and the shell closes its copy of every pipe end as soon as
+ * the child that needs it has been started, so it never holds more than one pipe at a time. A "<" in the
+ * first stage and a ">" or ">>" in the last stage are honored.
+ * 
+ * Each <(command) in a stage is started first, writing to a new pipe, and replaced by /dev/fd/N, the read
+ * end of that pipe. That descriptor is inherited by the stage alone: it is made inheritable just before the
+ * stage is started and closed in the shell right after. The command may be a pipeline but not a fan-out,
+ * and a substitution cannot take the place of a stage's command.
  * 
  * @param args Array of all arguments
- * @param pipe_index Index where pipe symbol is located
+ * @param arg_count Number of arguments
+ * @param in_fd Input of the pipeline, or -1 for the shell's; closed by this function
+ * @param out_fd Output of the pipeline, or -1 for the shell's; closed by this function
+ * @param pids Set to the process ID of each process started, or -1 for a stage that was not started
+ * @param names Set to the command name of each process
+ * @return Number of processes, the stages and the commands substituted into them, with the last stage
+ * last, or 0 if the pipeline is malformed or its redirection failed
  */
-void execute_piped_command(char *args[], int pipe_index)
+int start_piped_command(char *args[], int arg_count, int in_fd, int out_fd, pid_t pids[], char *names[])
 {
-    // Split arguments into two commands
-    char *cmd1[MAX_LINE / 2 + 1];
-    char *cmd2[MAX_LINE / 2 + 1];
+    // Start index and argument count of every stage
+    vector<int> starts(arg_count + 2);
+    vector<int> counts(arg_count + 1);
+    int stages = 0;
+    
+    starts[0] = 0;
+    const char *error = NULL;
+    for (int i = 0; i <= arg_count && error == NULL; i++) {
+        if (i < arg_count && args[i] == OP_SUBSTITUTE) {
+            int close_index = skip_substitution(args, i, arg_count);
+            // The command is started as a pipeline, which would pass a |> on as an argument
+            for (int j = i + 1; j < close_index; j++) {
+                if (args[j] == OP_FANOUT) {
+                    error = "Error: No fan-out in process substitution";
+                }
+            }
+            i = close_index;
+            continue;
+        }
+        if (i == arg_count || args[i] == OP_PIPE) {
+            counts[stages] = i - starts[stages];
+            if (counts[stages] == 0) {
+                if (stages == 0) {
+                    error = "Error: No command before pipe";
+                } else if (i == arg_count) {
+                    error = "Error: No command after pipe";
+                } else {
+                    error = "Error: No command between pipes";
+                }
+                break;
+            }
+            // The command name of a stage is kept in the job table, and the path of a substitution only lives
+            // as long as this call
+            int command = starts[stages];
+            while (command + 1 < i && (args[command] == OP_INPUT || args[command] == OP_OUTPUT ||
+                                       args[command] == OP_APPEND)) {
+                command += 2;
+            }
+            if (command < i && args[command] == OP_SUBSTITUTE) {
+                error = "Error: Process substitution in place of a command";
+                break;
+            }
+            args[i] = NULL;
+            stages++;
+            starts[stages] = i + 1;
+        }
+    }
+    if (error != NULL) {
+        fprintf(stderr, "%s\n", error);
+        if (in_fd >= 0) close(in_fd);
+        if (out_fd >= 0) close(out_fd);
+        return 0;
+    }
     
-    // Copy first command
-    for (int i = 0; i < pipe_index; i++) {
-        cmd1[i] = args[i];
+    // Start the substituted commands. Each takes at least three arguments, so the paths never move.
+    vector<substitution> substitutions;
+    substitutions.reserve(arg_count / 3 + 1);
+    int count = 0;
+    int ok = 1;
+    for (int s = 0; s < stages && ok; s++) {
+        char **stage_args = args + starts[s];
+        for (int i = 0; i < counts[s] && ok; i++) {
+            if (stage_args[i] != OP_SUBSTITUTE) {
+                continue;
+            }
+            int close_index = skip_substitution(stage_args, i, counts[s]);
+            stage_args[close_index] = NULL;
+            int pipefd[2];
+            if (close_index == i + 1) {
+                fprintf(stderr, "Error: No command in process substitution\n");
+                ok = 0;
+            } else if (pipe2(pipefd, O_CLOEXEC) < 0) {
+                perror("Pipe creation failed");
+                ok = 0;
+            } else {
+                int started = start_piped_command(stage_args + i + 1, close_index - i - 1, -1, pipefd[1],
+                                                  pids + count, names + count);
+                count += started;
+                substitutions.push_back(substitution{s, pipefd[0], ""});
+                snprintf(substitutions.back().path, sizeof(substitutions.back().path), "/dev/fd/%d",
+                         pipefd[0]);
+                ok = started > 0;
+            }
+            if (!ok) {
+                break;
+            }
+            // Replace <( command ) with the path, keeping the NULL that ends the stage
+            stage_args[i] = substitutions.back().path;
+            memmove(stage_args + i + 1, stage_args + close_index + 1,
+                    (counts[s] - close_index) * sizeof(stage_args[0]));
+            counts[s] -= close_index - i;
+        }
     }
-    cmd1[pipe_index] = NULL;
     
-    // Copy second command
-    int j = 0;
-    for (int i = pipe_index + 1; args[i] != NULL; i++) {
-        cmd2[j++] = args[i];
+    // Redirection applies to the ends of the pipeline
+    int input_fd = ok ? check_input_redirection(args + starts[0], &counts[0]) : -2;
+    int output_fd = (input_fd != -2) ? check_output_redirection(args + starts[stages - 1], &counts[stages - 1])
+                                     : -2;
+    if (input_fd == -2 || output_fd == -2) {
+        if (input_fd >= 0) close(input_fd);
+        if (in_fd >= 0) close(in_fd);
+        if (out_fd >= 0) close(out_fd);
+        for (size_t i = 0; i < substitutions.size(); i++) {
+            close(substitutions[i].fd);
+        }
+        return 0;
+    }
+    if (input_fd >= 0) {
+        if (in_fd >= 0) close(in_fd);
+    } else {
+        input_fd = in_fd;
+    }
+    if (output_fd >= 0) {
+        if (out_fd >= 0) close(out_fd);
+    } else {
+        output_fd = out_fd;
     }
-    cmd2[j] = NULL;
     
-    // Validate that both commands exist
-    if (pipe_index == 0 || cmd1[0] == NULL) {
-        fprintf(stderr, "Error: No command before pipe\n");
-        return;
+    // Read end of the pipe from the previous stage, or the input of the pipeline
+    int prev_fd = input_fd;
+    size_t next_substitution = 0;
+    
+    int s;
+    for (s = 0; s < stages; s++) {
+        int pipefd[2] = {-1, -1};
+        if (s < stages - 1 && pipe2(pipefd, O_CLOEXEC) < 0) {
+            perror("Pipe creation failed");
+            break;
+        }
+        int next_fd = (s < stages - 1) ? pipefd[1] : output_fd;
+        size_t first_substitution = next_substitution;
+        while (next_substitution < substitutions.size() && substitutions[next_substitution].stage == s) {
+            fcntl(substitutions[next_substitution++].fd, F_SETFD, 0);
+        }
+    
+        // The child reads from the previous stage and writes to the next. Every other descriptor of the
+        // pipeline is close-on-exec, so the child does not keep a pipe open that belongs to another stage.
+        pid_t pid = launch_command(args + starts[s], prev_fd, next_fd, backend);
+    
+        // Parent: the ends this child used are no longer needed here
+        if (prev_fd >= 0) close(prev_fd);
+        if (next_fd >= 0) close(next_fd);
+        for (size_t i = first_substitution; i < next_substitution; i++) {
+            close(substitutions[i].fd);
+        }
+        prev_fd = pipefd[0];
+        // If the child was not started, the later stages still run, and see end of file or a closed pipe
+        // as they would if it had exited
+        pids[count] = pid;
+        names[count++] = args[starts[s]];
     }
-    if (j == 0 || cmd2[0] == NULL) {
-        fprintf(stderr, "Error: No command after pipe\n");
-        return;
+    
+    // After a pipe error, close what was meant for the stages that were not started
+    if (prev_fd >= 0) close(prev_fd);
+    if (s < stages && output_fd >= 0) close(output_fd);
+    for (; next_substitution < substitutions.size(); next_substitution++) {
+        close(substitutions[next_substitution].fd);
+    }
+    for (; s < stages; s++) {
+        pids[count] = -1;
+        names[count++] = args[starts[s]];
     }
+    return count;
+}
+
+/**
+ * @brief Start a producer pipeline whose output is copied to several consumer pipelines
+ * (producer |> consumer1 |> ... |> consumerN), without waiting for it
+ * 
+ * Every consumer reads all of the producer's output, which is read only once. Between them runs a copy of
+ * the shell, named tee in the job table, that passes the data on with fan_out(); it is a fork of the shell
+ * whatever the backend, since it runs no program. Without |> this is start_piped_command.
+ * 
+ * @param args Array of all arguments
+ * @param arg_count Number of arguments
+ * @param pids Set to the process ID of each process started, or -1 for a stage that was not started
+ * @param names Set to the command name of each process
+ * @return Number of processes, with the last stage of the last consumer last, or 0 if the command line is
+ * malformed or the redirection of the producer failed
+ */
+int start_fanout(char *args[], int arg_count, pid_t pids[], char *names[])
+{
+    // Start index of every pipeline, producer first
+    vector<int> starts;
+    starts.push_back(0);
+    for (int i = 0; i < arg_count; i++) {
+        if (args[i] == OP_SUBSTITUTE) {
+            i = skip_substitution(args, i, arg_count);
+        } else if (args[i] == OP_FANOUT) {
+            if (i == starts.back() || i == arg_count - 1) {
+                fprintf(stderr, "Error: No command %s fan-out\n", (i == starts.back()) ? "before" : "after");
+                return 0;
+            }
+            args[i] = NULL;
+            starts.push_back(i + 1);
+        }
+    }
+    if (starts.size() == 1) {
+        return start_piped_command(args, arg_count, -1, -1, pids, names);
+    }
+    starts.push_back(arg_count + 1);
     
-    // Create pipe
     int pipefd[2];
-    if (pipe(pipefd) < 0) {
+    if (pipe2(pipefd, O_CLOEXEC) < 0) {
         perror("Pipe creation failed");
-        return;
+        return 0;
+    }
+    int count = start_piped_command(args, starts[1] - 1, -1, pipefd[1], pids, names);
+    if (count == 0) {
+        close(pipefd[0]);
+        return 0;
     }
     
-    pid_t pid1 = fork();
+    // Consumers first, so the copy of the shell does not hold the read end of any of their pipes. A
+    // consumer that cannot be started is left out.
+    int tee_index = count++;
+    vector<int> outputs;
+    for (size_t c = 1; c + 1 < starts.size(); c++) {
+        int consumer[2];
+        if (pipe2(consumer, O_CLOEXEC) < 0) {
+            perror("Pipe creation failed");
+            break;
+        }
+        int started = start_piped_command(args + starts[c], starts[c + 1] - starts[c] - 1, consumer[0], -1,
+                                          pids + count, names + count);
+        if (started > 0) {
+            outputs.push_back(consumer[1]);
+            count += started;
+        } else {
+            close(consumer[1]);
+        }
+    }
     
-    if (pid1 < 0) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        // A consumer that exits early is reported by write() as EPIPE
+        signal(SIGPIPE, SIG_IGN);
+        _exit(fan_out(pipefd[0], outputs.data(), (int) outputs.size()) < 0 ? 1 : 0);
+    }
+    if (pid < 0) {
         perror("Fork failed");
-        return;
     }
-    else if (pid1 == 0) {
-        // First child: writes to pipe
-        close(pipefd[0]); // Close read end
-        dup2(pipefd[1], STDOUT_FILENO);
-        close(pipefd[1]);
-        
-        if (execvp(cmd1[0], cmd1) < 0) {
-            perror("First command execution failed");
-            exit(1);
+    close(pipefd[0]);
+    for (size_t i = 0; i < outputs.size(); i++) {
+        close(outputs[i]);
+    }
+    pids[tee_index] = pid;
+    names[tee_index] = (char *) "tee";
+    return count;
+}
+
+/**
+ * @brief Execute a pipeline of any number of commands, possibly with fan-out and process substitution, in
+ * the foreground or in the background
+ * 
+ * @param args Array of all arguments
+ * @param arg_count Number of arguments
+ * @param text The command line, for the job table
+ * @param timed 1 to report the resources used by each stage and by the whole pipeline
+ */
+void execute_piped_command(char *args[], int arg_count, const char *text, int timed)
+{
+    int background = check_background(args, &arg_count);
+    vector<pid_t> pids(arg_count);
+    vector<char *> names(arg_count);
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    int count = start_fanout(args, arg_count, pids.data(), names.data());
+    if (count > 0) {
+        run_job(pids.data(), names.data(), count, text, (background ? JOB_BACKGROUND : 0) | (timed ? JOB_TIMED : 0),
+                started);
+    }
+}
+
+// One command line of a batch run
+struct batch_line {
+    // Line number in the script and the line as written
+    int number;
+    string text;
+    int status;
+    double seconds;
+    bool done;
+};
+
+/**
+ * @brief Run the command lines of a script, up to a number of them at once, like xargs -P
+ * 
+ * Lines are independent of each other: each is started as soon as fewer than max_jobs lines are running,
+ * as a job of the job table, and the jobs are waited for in whatever order they finish. The exit status and
+ * run time of each line are still printed in script order, as soon as it and all the lines before it are
+ * done. Blank lines and lines starting with '#' are skipped. The jobs of a batch are its own lines, so jobs,
+ * fg and wait are refused: waiting for a job here would take it away from the line that started it.
+ * 
+ * @param file Path of the script
+ * @param max_jobs Maximum number of lines running at once
+ * @return 0 if every line exited with status 0, 1 otherwise
+ */
+int run_batch(const char *file, int max_jobs)
+{
+    FILE *script = fopen(file, "r");
+    if (script == NULL) {
+        perror("Error opening script");
+        return 1;
+    }
+    vector<batch_line> lines;
+    char *text = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    int number = 0;
+    while ((length = getline(&text, &capacity, script)) >= 0) {
+        number++;
+        text[strcspn(text, "\n")] = 0;
+        size_t first = strspn(text, " \t");
+        if (text[first] == 0 || text[first] == '#') {
+            continue;
         }
+        lines.push_back(batch_line{number, string(text), 0, 0, false});
     }
-    else {
-        pid_t pid2 = fork();
-        
-        if (pid2 < 0) {
-            perror("Fork failed");
-            return;
+    free(text);
+    fclose(script);
+    
+    // Line index of each running job
+    unordered_map<int, size_t> owner;
+    size_t next_start = 0;
+    size_t next_report = 0;
+    int running_lines = 0;
+    int failed = 0;
+    // Buffers reused for every line
+    command_line parsed;
+    vector<pid_t> pids;
+    vector<char *> names;
+    init_jobs();
+    auto t1 = std::chrono::steady_clock::now();
+    
+    while (next_report < lines.size()) {
+        // Start lines until max_jobs are running
+        while (running_lines < max_jobs && next_start < lines.size()) {
+            batch_line &line = lines[next_start++];
+            struct timespec started;
+            clock_gettime(CLOCK_MONOTONIC, &started);
+            line.status = 1;
+            parsed.text = line.text;
+            int num_args = tokenize_command_line(parsed);
+            if (num_args < 0) {
+                line.done = true;
+                continue;
+            }
+            char **args = parsed.args.data();
+            // Every line already runs alongside the others, so a trailing & changes nothing
+            check_background(args, &num_args);
+            int timed = check_time_prefix(args, &num_args);
+            pids.resize(num_args + 1);
+            names.resize(num_args + 1);
+            int stages;
+            builtin_function builtin = (num_args > 0 && check_pipe(args, num_args) < 0) ? find_builtin(args[0]) : NULL;
+            if (builtin != NULL && is_job_control_builtin(args[0])) {
+                fprintf(stderr, "%s: not available in batch mode\n", args[0]);
+                line.done = true;
+                continue;
+            }
+            if (builtin != NULL) {
+                // Runs to completion here, without a process
+                line.status = execute_builtin(builtin, args, num_args, timed);
+                struct timespec ended;
+                clock_gettime(CLOCK_MONOTONIC, &ended);
+                line.seconds = seconds_between(started, ended);
+                line.done = true;
+                if (exit_requested) {
+                    // The lines after exit are not run
+                    lines.resize(next_start);
+                }
+                continue;
+            }
+            if (num_args == 0) {
+                stages = 0;
+            } else if (check_pipe(args, num_args) >= 0) {
+                stages = start_fanout(args, num_args, pids.data(), names.data());
+            } else {
+                pids[0] = start_simple_command(args, num_args);
+                names[0] = args[0];
+                stages = (pids[0] == -2) ? 0 : 1;
+            }
+            int id = (stages > 0) ? add_job(pids.data(), names.data(), stages, line.text.c_str(),
+                                            timed ? JOB_TIMED : 0, started) : 0;
+            if (id != 0) {
+                owner[id] = next_start - 1;
+                running_lines++;
+            } else {
+                // Nothing was started: a command that could not be executed, as in other shells, or a
+                // redirection error
+                line.status = (stages > 0) ? 127 : 1;
+                line.done = true;
+            }
         }
-        else if (pid2 == 0) {
-            // Second child: reads from pipe
-            close(pipefd[1]); // Close write end
-            dup2(pipefd[0], STDIN_FILENO);
-            close(pipefd[0]);
-            
-            if (execvp(cmd2[0], cmd2) < 0) {
-                perror("Second command execution failed");
-                exit(1);
+        
+        // Report every finished line that all earlier lines have been reported before
+        while (next_report < lines.size() && lines[next_report].done) {
+            batch_line &line = lines[next_report++];
+            if (line.status != 0) {
+                failed++;
             }
+            printf("[%d] exit %d, %.3f s: %s\n", line.number, line.status, line.seconds, line.text.c_str());
+            fflush(stdout);
         }
-        else {
-            // Parent process
-            close(pipefd[0]);
-            close(pipefd[1]);
-            
-            // Wait for both children
-            waitpid(pid1, NULL, 0);
-            waitpid(pid2, NULL, 0);
+        if (running_lines == 0) {
+            continue;
+        }
+        
+        // Wait for any line to finish
+        int status;
+        double seconds;
+        int id = wait_any_job(&status, &seconds);
+        if (id == 0) {
+            // The jobs are gone from the table: their lines are reported as failed rather than dropped
+            for (auto &running : owner) {
+                lines[running.second].done = true;
+            }
+            owner.clear();
+            running_lines = 0;
+            continue;
         }
+        batch_line &line = lines[owner[id]];
+        owner.erase(id);
+        line.status = status;
+        line.seconds = seconds;
+        line.done = true;
+        running_lines--;
     }
+    
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+    printf("%zu commands, %d failed, %.3f s wall clock with up to %d at once\n", lines.size(), failed, wall,
+           max_jobs);
+    return failed == 0 ? 0 : 1;
 }
 
 /**
@@ -315,73 +792,111 @@ void execute_piped_command(char *args[], int pipe_index)
  */
 int main(int argc, char *argv[])
 {
-    char command[MAX_LINE];
-    char *args[MAX_LINE / 2 + 1];
+    command_line line;
     int should_run = 1;
     
-    // History feature: store the last command
-    char history[MAX_LINE];
-    int has_history = 0;
+    // Options: -b fork|spawn selects how commands are started, -f runs a script with up to -j lines at once,
+    // -l logs the resource usage of every job to a file
+    const char *script = NULL;
+    int max_jobs = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:f:j:l:")) != -1) {
+        int ok = 1;
+        if (opt == 'b') {
+            ok = parse_backend(optarg, &backend);
+        } else if (opt == 'l') {
+            ok = set_job_log(optarg);
+        } else if (opt == 'f') {
+            script = optarg;
+        } else if (opt == 'j') {
+            max_jobs = atoi(optarg);
+            ok = max_jobs > 0;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            fprintf(stderr, "Usage: %s [-b fork|spawn] [-l logfile] [-f script [-j jobs]]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (script != NULL) {
+        return run_batch(script, max_jobs);
+    }
+    init_jobs();
+    
+    // History feature: kept in $OSH_HISTFILE, or ~/.osh_history
+    const char *history_file = getenv("OSH_HISTFILE");
+    string default_file = string(getenv("HOME") != NULL ? getenv("HOME") : ".") + "/.osh_history";
+    open_history(history_file != NULL ? history_file : default_file.c_str());
     
     printf("Simple UNIX Shell - CS433 Assignment 2\n");
-    printf("Type 'exit' to quit, '!!' to repeat last command\n");
-    printf("Supports: I/O redirection (<, >, >>), pipes (|), background (&)\n\n");
+    printf("Type 'exit' to quit, '!!' to repeat last command, '!n' to repeat command n, 'history' to list them\n");
+    printf("Supports: I/O redirection (<, >, >>), pipes (|), background (&), jobs, fg, wait\n\n");
     
     while (should_run)
     {
+        // Report the background jobs that have finished since the last prompt
+        report_done_jobs();
         printf("osh> ");
         fflush(stdout);
         
-        // Read the input command
-        if (fgets(command, MAX_LINE, stdin) == NULL) {
+        // Read the input command, however long
+        if (!read_command_line(line, stdin)) {
             break;
         }
         
-        // Handle history feature
-        if (strcmp(command, "!!\n") == 0) {
-            if (!has_history) {
-                printf("No commands in history.\n");
-                continue;
-            }
-            // Use the last command
-            strcpy(command, history);
-            printf("%s", command);
+        // Handle history feature: replace !!, !n, !-n or !prefix with the command it refers to
+        int expanded = expand_history(line.text);
+        if (expanded < 0) {
+            continue;
         }
-        else {
-            // Save current command to history (if not empty)
-            if (command[0] != '\n') {
-                strcpy(history, command);
-                has_history = 1;
-            }
+        if (expanded) {
+            printf("%s\n", line.text.c_str());
+        }
+        // Save current command to history (if not empty)
+        if (line.text.find_first_not_of(" \t") != string::npos) {
+            add_history(line.text);
         }
         
-        // Parse the input command
-        int num_args = parse_command(command, args);
+        // Parse the input command; line.text keeps the line as typed, for the job table
+        int num_args = tokenize_command_line(line);
+        char **args = line.args.data();
+        const char *text = line.text.c_str();
         
         // Handle empty command
-        if (num_args == 0) {
+        if (num_args <= 0) {
             continue;
         }
         
-        // Check for exit command
-        if (strcmp(args[0], "exit") == 0) {
-            should_run = 0;
-            continue;
-        }
+        // A time prefix reports the time and resources the rest of the line used, per stage for a pipeline
+        int timed = check_time_prefix(args, &num_args);
         
-        // Check for pipe
+        // Check for pipe, fan-out or process substitution
         int pipe_index = check_pipe(args, num_args);
         
+        // Builtins (cd, pwd, echo, export, true, false, exit, hash, jobs, fg, wait) run in the shell itself.
+        // In a pipeline every stage is a process, so there the external command of the same name runs; so
+        // it does with fan-out or a process substitution.
+        builtin_function builtin = (pipe_index < 0) ? find_builtin(args[0]) : NULL;
+        if (builtin != NULL) {
+            check_background(args, &num_args);
+            execute_builtin(builtin, args, num_args, timed);
+            if (exit_requested) {
+                should_run = 0;
+            }
+            continue;
+        }
+        
         if (pipe_index >= 0) {
             // Execute piped command
-            execute_piped_command(args, pipe_index);
+            execute_piped_command(args, num_args, text, timed);
         }
         else {
             // Execute simple command (with possible I/O redirection)
-            execute_simple_command(args, num_args);
+            execute_simple_command(args, num_args, text, timed);
         }
     }
     
     printf("Shell terminated.\n");
-    return 0;
+    return exit_status;
 }
@@ -0,0 +1,321 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file shellbench.cpp
+ * @brief Benchmark suite for the overhead of the shell. It writes script files to a temporary directory and
+ * runs them through ./prog2 -f, headless, once per backend, measuring:
+ *   - commands per second for a script of /bin/true lines
+ *   - the latency from starting a child to its exec, through launch_command
+ *   - pipe throughput through 2-, 4- and 8-stage pipelines of head -c N /dev/zero | cat | ... | cat
+ *   - the extra cost of < and > redirection on an external command and on a builtin
+ * Each script is timed from outside the shell, several times, and the fastest run is kept. The time of an
+ * empty script is subtracted, so the shell's own startup is not counted. A difference that is not above
+ * zero is lost in the noise, and is printed as "noise" rather than as a number; more commands per script
+ * or more repeats fix it. The results of both backends are printed side by side.
+ *
+ * Usage: ./shellbench [-b fork|spawn] [-n commands] [-m pipe_mb] [-r repeats] [-p shell]
+ *   -b  run one backend only (default both)
+ *   -n  number of command lines per script (default 2000)
+ *   -m  megabytes sent through each pipeline (default 256)
+ *   -r  number of runs of each script, of which the fastest is kept (default 5)
+ *   -p  the shell to run (default ./prog2)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <chrono>
+#include <string>
+#include "launch.h"
+
+// Number of stages of each pipeline measured
+static const int PIPELINE_STAGES[] = {2, 4, 8};
+static const int NUM_PIPELINES = sizeof(PIPELINE_STAGES) / sizeof(PIPELINE_STAGES[0]);
+
+// The results of one backend
+struct bench_result {
+    double commands_per_second;
+    double exec_latency_us;
+    double pipe_gb_per_second[NUM_PIPELINES];
+    double redirect_external_us;
+    double redirect_builtin_us;
+};
+
+// Where the scripts and redirection files are written
+static std::string work_dir;
+static int null_fd = -1;
+
+/**
+ * @brief Write a script file to the work directory
+ *
+ * @param name File name within the work directory
+ * @param line Command line to write
+ * @param count Number of times to write it
+ * @return Path of the script, or an empty string if it could not be written
+ */
+static std::string write_script(const char *name, const std::string &line, int count)
+{
+    std::string path = work_dir + "/" + name;
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == NULL) {
+        perror("Error writing script");
+        return "";
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%s\n", line.c_str());
+    }
+    fclose(file);
+    return path;
+}
+
+/**
+ * @brief Run a script through the shell in batch mode, one line at a time, several times, and time it
+ *
+ * The fastest run is kept: other load on the machine only ever makes a run slower, so the minimum is the
+ * estimate least disturbed by it.
+ *
+ * @param shell Path of the shell
+ * @param backend Backend the shell is told to use
+ * @param script Path of the script
+ * @param repeats Number of runs
+ * @return Wall-clock seconds from starting the shell to reaping it in the fastest run, or -1 if the shell
+ * or a line failed
+ */
+static double run_script(const char *shell, launch_backend backend, const std::string &script, int repeats)
+{
+    if (script.empty()) {
+        return -1;
+    }
+    char *args[] = {(char *) shell, (char *) "-b", (char *) backend_name(backend), (char *) "-f",
+                    (char *) script.c_str(), (char *) "-j", (char *) "1", NULL};
+    double fastest = -1;
+    for (int r = 0; r < repeats; r++) {
+        auto t1 = std::chrono::steady_clock::now();
+        // The shell always starts the same way, so the difference between backends is in the commands it runs
+        pid_t pid = launch_command(args, -1, null_fd, LAUNCH_SPAWN);
+        if (pid < 0) {
+            return -1;
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        auto t2 = std::chrono::steady_clock::now();
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s failed on %s\n", shell, script.c_str());
+            return -1;
+        }
+        double seconds = std::chrono::duration<double>(t2 - t1).count();
+        if (fastest < 0 || seconds < fastest) {
+            fastest = seconds;
+        }
+    }
+    return fastest;
+}
+
+/**
+ * @brief Average time from launching /bin/true to its exec
+ *
+ * The child inherits the write end of a close-on-exec pipe, and the shell reads the other end: the read
+ * returns end of file at the moment the exec succeeds, before the new program runs at all.
+ *
+ * @param backend How to start the command
+ * @param iterations Number of commands to start
+ * @return Microseconds per command, or -1 if a command could not be started
+ */
+static double time_exec_latency(launch_backend backend, int iterations)
+{
+    char *args[] = {(char *) "/bin/true", NULL};
+    double total = 0;
+    for (int i = 0; i < iterations; i++) {
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) < 0) {
+            perror("Pipe failed");
+            return -1;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        pid_t pid = launch_command(args, -1, null_fd, backend);
+        close(fds[1]);
+        char c;
+        while (pid >= 0 && read(fds[0], &c, 1) > 0) {
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        close(fds[0]);
+        if (pid < 0) {
+            return -1;
+        }
+        waitpid(pid, NULL, 0);
+        total += std::chrono::duration<double, std::micro>(t2 - t1).count();
+    }
+    return total / iterations;
+}
+
+/**
+ * @brief Run every benchmark with one backend
+ *
+ * @param shell Path of the shell
+ * @param backend Backend to measure
+ * @param commands Number of command lines per script
+ * @param pipe_mb Megabytes sent through each pipeline
+ * @param repeats Number of runs of each script
+ * @param result Set to the measurements; a measurement that is not above zero was lost in the noise
+ * @return 0 on success, -1 if a script failed
+ */
+static int run_backend(const char *shell, launch_backend backend, int commands, long pipe_mb, int repeats,
+                       bench_result *result)
+{
+    std::string in_file = work_dir + "/in", out_file = work_dir + "/out";
+    std::string redirect = " < " + in_file + " > " + out_file;
+
+    double empty = run_script(shell, backend, write_script("empty.sh", "", 0), repeats);
+    double external = run_script(shell, backend, write_script("true.sh", "/bin/true", commands), repeats);
+    double external_redirected = run_script(shell, backend, write_script("true_redir.sh", "/bin/true" + redirect,
+                                                                         commands), repeats);
+    double builtin = run_script(shell, backend, write_script("builtin.sh", "true", commands), repeats);
+    double builtin_redirected = run_script(shell, backend, write_script("builtin_redir.sh", "true" + redirect,
+                                                                        commands), repeats);
+    if (empty < 0 || external < 0 || external_redirected < 0 || builtin < 0 || builtin_redirected < 0) {
+        return -1;
+    }
+    result->commands_per_second = (external > empty) ? commands / (external - empty) : 0;
+    result->redirect_external_us = (external_redirected - external) * 1e6 / commands;
+    result->redirect_builtin_us = (builtin_redirected - builtin) * 1e6 / commands;
+
+    result->exec_latency_us = time_exec_latency(backend, commands);
+    if (result->exec_latency_us < 0) {
+        return -1;
+    }
+
+    for (int p = 0; p < NUM_PIPELINES; p++) {
+        std::string line = "head -c " + std::to_string(pipe_mb << 20) + " /dev/zero";
+        for (int s = 1; s < PIPELINE_STAGES[p]; s++) {
+            line += " | cat";
+        }
+        line += " > /dev/null";
+        double seconds = run_script(shell, backend, write_script("pipeline.sh", line, 1), repeats);
+        if (seconds < 0) {
+            return -1;
+        }
+        result->pipe_gb_per_second[p] = (seconds > empty) ? (double) (pipe_mb << 20) / (seconds - empty) / 1e9 : 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Print one measurement of each backend in a column, or "noise" for one that is not above zero
+ *
+ * @param label Name of the measurement
+ * @param format printf format of a value, 12 characters wide
+ * @param values The measurement of each backend
+ * @param count Number of backends
+ */
+static void print_row(const char *label, const char *format, const double values[], int count)
+{
+    printf("\n%-26s", label);
+    for (int b = 0; b < count; b++) {
+        if (values[b] > 0) {
+            printf(format, values[b]);
+        } else {
+            printf(" %12s", "noise");
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *shell = "./prog2";
+    int commands = 2000;
+    long pipe_mb = 256;
+    int repeats = 5;
+    launch_backend backends[] = {LAUNCH_FORK, LAUNCH_SPAWN};
+    int num_backends = 2;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:n:m:r:p:")) != -1) {
+        int ok = 1;
+        if (opt == 'b') {
+            ok = parse_backend(optarg, &backends[0]);
+            num_backends = 1;
+        } else if (opt == 'n') {
+            commands = atoi(optarg);
+            ok = commands > 0;
+        } else if (opt == 'm') {
+            pipe_mb = atol(optarg);
+            ok = pipe_mb > 0;
+        } else if (opt == 'r') {
+            repeats = atoi(optarg);
+            ok = repeats > 0;
+        } else if (opt == 'p') {
+            shell = optarg;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            fprintf(stderr, "Usage: %s [-b fork|spawn] [-n commands] [-m pipe_mb] [-r repeats] [-p shell]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char dir[] = "/tmp/shellbench.XXXXXX";
+    if (mkdtemp(dir) == NULL) {
+        perror("Error creating work directory");
+        return 1;
+    }
+    work_dir = dir;
+    null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd < 0) {
+        perror("Error opening /dev/null");
+        return 1;
+    }
+    // The input of the redirection benchmark; the output file is created by the shell
+    write_script("in", "", 0);
+
+    bench_result results[2];
+    int failed = 0;
+    for (int b = 0; b < num_backends && !failed; b++) {
+        failed = run_backend(shell, backends[b], commands, pipe_mb, repeats, &results[b]) < 0;
+    }
+
+    const char *files[] = {"empty.sh", "true.sh", "true_redir.sh", "builtin.sh", "builtin_redir.sh", "pipeline.sh",
+                           "in", "out"};
+    for (const char *file : files) {
+        unlink((work_dir + "/" + file).c_str());
+    }
+    rmdir(dir);
+    close(null_fd);
+    if (failed) {
+        return 1;
+    }
+
+    printf("%s, %d commands per script, %ld MB per pipeline, fastest of %d runs\n", shell, commands, pipe_mb,
+           repeats);
+    printf("%-26s", "");
+    for (int b = 0; b < num_backends; b++) {
+        printf(" %12s", backend_name(backends[b]));
+    }
+    double values[2];
+    for (int b = 0; b < num_backends; b++) {
+        values[b] = results[b].commands_per_second;
+    }
+    print_row("/bin/true commands/s", " %12.0f", values, num_backends);
+    for (int b = 0; b < num_backends; b++) {
+        values[b] = results[b].exec_latency_us;
+    }
+    print_row("launch to exec us", " %12.1f", values, num_backends);
+    for (int p = 0; p < NUM_PIPELINES; p++) {
+        char label[32];
+        snprintf(label, sizeof(label), "%d-stage pipeline GB/s", PIPELINE_STAGES[p]);
+        for (int b = 0; b < num_backends; b++) {
+            values[b] = results[b].pipe_gb_per_second[p];
+        }
+        print_row(label, " %12.3f", values, num_backends);
+    }
+    for (int b = 0; b < num_backends; b++) {
+        values[b] = results[b].redirect_external_us;
+    }
+    print_row("< > on /bin/true us", " %12.1f", values, num_backends);
+    for (int b = 0; b < num_backends; b++) {
+        values[b] = results[b].redirect_builtin_us;
+    }
+    print_row("< > on builtin true us", " %12.1f", values, num_backends);
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,92 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file spawnbench.cpp
+ * @brief Microbenchmark of the two ways the shell starts commands. It runs /bin/true many times through
+ * launch_command with each backend and reports the average time from launch to the end of waitpid, first
+ * with a small address space and then after the process has allocated and touched a large heap, as a long
+ * running shell would.
+ *
+ * Usage: ./spawnbench [iterations] [heap_mb]
+ *   iterations  number of commands started per backend and heap size (default 2000)
+ *   heap_mb     size of the heap touched before the second round, in MB (default 512)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <chrono>
+#include "launch.h"
+
+/**
+ * @brief Average latency of starting and reaping /bin/true
+ * 
+ * @param backend How to start the command
+ * @param iterations Number of commands to run
+ * @param null_fd Descriptor the command's output is redirected to, so the file actions are exercised too
+ * @return Microseconds per command, or -1 if a command could not be started
+ */
+static double time_backend(launch_backend backend, int iterations, int null_fd)
+{
+    char *args[] = {(char *) "/bin/true", NULL};
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        pid_t pid = launch_command(args, -1, null_fd, backend);
+        if (pid < 0) {
+            return -1;
+        }
+        waitpid(pid, NULL, 0);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(t2 - t1).count() / iterations;
+}
+
+/**
+ * @brief Time both backends and print one line of results
+ * 
+ * @param label Description of the address space
+ * @param iterations Number of commands per backend
+ * @param null_fd Descriptor of /dev/null
+ */
+static void run_round(const char *label, int iterations, int null_fd)
+{
+    double fork_us = time_backend(LAUNCH_FORK, iterations, null_fd);
+    double spawn_us = time_backend(LAUNCH_SPAWN, iterations, null_fd);
+    printf("%-14s fork %9.1f us   spawn %9.1f us   speedup %.2fx\n", label, fork_us, spawn_us,
+           fork_us / spawn_us);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000;
+    long heap_mb = (argc > 2) ? atol(argv[2]) : 512;
+    if (iterations <= 0 || heap_mb < 0) {
+        fprintf(stderr, "Usage: %s [iterations] [heap_mb]\n", argv[0]);
+        return 1;
+    }
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd < 0) {
+        perror("Error opening /dev/null");
+        return 1;
+    }
+    
+    printf("Average latency of starting and reaping /bin/true, %d runs each\n", iterations);
+    run_round("small heap", iterations, null_fd);
+    
+    // Touch every page, so fork has a page table entry to copy for each of them
+    size_t bytes = (size_t) heap_mb << 20;
+    char *heap = (char *) malloc(bytes);
+    if (heap == NULL) {
+        fprintf(stderr, "Could not allocate %ld MB\n", heap_mb);
+        return 1;
+    }
+    memset(heap, 1, bytes);
+    char label[32];
+    snprintf(label, sizeof(label), "%ld MB heap", heap_mb);
+    run_round(label, iterations, null_fd);
+    
+    free(heap);
+    close(null_fd);
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file tokenizer.cpp
+ * @brief Reading command lines of any length and splitting them into words and operators
+ * @version 1.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tokenizer.h"
+
+using namespace std;
+
+const char OP_PIPE[] = "|";
+const char OP_INPUT[] = "<";
+const char OP_OUTPUT[] = ">";
+const char OP_APPEND[] = ">>";
+const char OP_BACKGROUND[] = "&";
+const char OP_FANOUT[] = "|>";
+const char OP_SUBSTITUTE[] = "<(";
+const char OP_SUBSTITUTE_END[] = ")";
+
+/**
+ * @brief Free the getline buffer
+ */
+command_line::~command_line()
+{
+    free(read_buffer);
+}
+
+/**
+ * @brief Read the next line, of any length, into line.text
+ * 
+ * @param line The command line to fill
+ * @param in The stream to read
+ * @return 1 if a line was read, 0 at end of input
+ */
+int read_command_line(command_line &line, FILE *in)
+{
+    ssize_t length = getline(&line.read_buffer, &line.read_capacity, in);
+    if (length < 0) {
+        return 0;
+    }
+    if (length > 0 && line.read_buffer[length - 1] == '\n') {
+        length--;
+    }
+    line.text.assign(line.read_buffer, length);
+    return 1;
+}
+
+/**
+ * @brief The operator starting at a character, if any
+ * 
+ * @param p The character
+ * @param length Set to the number of characters of the operator
+ * @param nested Number of <( not yet closed; ) is an operator only inside one
+ * @return The operator, or NULL
+ */
+static const char *match_operator(const char *p, size_t *length, int nested)
+{
+    *length = 1;
+    switch (*p) {
+    case '|':
+        if (p[1] == '>') {
+            *length = 2;
+            return OP_FANOUT;
+        }
+        return OP_PIPE;
+    case '<':
+        if (p[1] == '(') {
+            *length = 2;
+            return OP_SUBSTITUTE;
+        }
+        return OP_INPUT;
+    case ')':
+        return nested > 0 ? OP_SUBSTITUTE_END : NULL;
+    case '&':
+        return OP_BACKGROUND;
+    case '>':
+        if (p[1] == '>') {
+            *length = 2;
+            return OP_APPEND;
+        }
+        return OP_OUTPUT;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * @brief Split line.text into tokens, in one pass over it
+ * 
+ * @param line The command line; fills tokens and args
+ * @return Number of tokens, or -1 (after printing an error) if a quote or a <( is not closed
+ */
+int tokenize_command_line(command_line &line)
+{
+    const char *p = line.text.c_str();
+    const char *end = p + line.text.size();
+    // Unquoting never makes a word longer, and each word gets one NUL for the space or operator that ended it
+    // or, for the last one, the extra byte
+    line.arena.resize(line.text.size() + 1);
+    char *out = &line.arena[0];
+    line.tokens.clear();
+    int nested = 0;
+    
+    while (true) {
+        while (p < end && (*p == ' ' || *p == '\t')) {
+            p++;
+        }
+        if (p == end) {
+            break;
+        }
+        size_t length;
+        const char *op = match_operator(p, &length, nested);
+        if (op != NULL) {
+            if (op == OP_SUBSTITUTE) {
+                nested++;
+            } else if (op == OP_SUBSTITUTE_END) {
+                nested--;
+            }
+            line.tokens.push_back(string_view(op, length));
+            p += length;
+            continue;
+        }
+        
+        // A word: copy it into the arena without its quotes and escapes
+        char *word = out;
+        while (p < end && *p != ' ' && *p != '\t' && match_operator(p, &length, nested) == NULL) {
+            if (*p == '\'') {
+                const char *close = (const char *) memchr(p + 1, '\'', end - p - 1);
+                if (close == NULL) {
+                    fprintf(stderr, "Error: unterminated single quote\n");
+                    return -1;
+                }
+                memcpy(out, p + 1, close - p - 1);
+                out += close - p - 1;
+                p = close + 1;
+            } else if (*p == '"') {
+                p++;
+                while (p < end && *p != '"') {
+                    if (*p == '\\' && p + 1 < end && strchr("\"\\$`", p[1]) != NULL) {
+                        p++;
+                    }
+                    *out++ = *p++;
+                }
+                if (p == end) {
+                    fprintf(stderr, "Error: unterminated double quote\n");
+                    return -1;
+                }
+                p++;
+            } else if (*p == '\\' && p + 1 < end) {
+                *out++ = p[1];
+                p += 2;
+            } else {
+                *out++ = *p++;
+            }
+        }
+        line.tokens.push_back(string_view(word, out - word));
+        *out++ = 0;
+    }
+    if (nested > 0) {
+        fprintf(stderr, "Error: unterminated process substitution\n");
+        return -1;
+    }
+    
+    line.args.resize(line.tokens.size() + 1);
+    for (size_t i = 0; i < line.tokens.size(); i++) {
+        line.args[i] = const_cast<char *>(line.tokens[i].data());
+    }
+    line.args[line.tokens.size()] = NULL;
+    return (int) line.tokens.size();
+}
@@ -0,0 +1,74 @@
+/**
+ * Assignment 2: Simple UNIX Shell
+ * @file tokenizer.h
+ * @brief Reading command lines of any length and splitting them into words and operators
+ * @version 1.0
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief The operators of the shell. An operator token is one of these pointers, so a quoted "|" or "<" is
+ * an ordinary word: compare with ==, not strcmp.
+ */
+extern const char OP_PIPE[];
+extern const char OP_INPUT[];
+extern const char OP_OUTPUT[];
+extern const char OP_APPEND[];
+extern const char OP_BACKGROUND[];
+extern const char OP_FANOUT[];
+extern const char OP_SUBSTITUTE[];
+extern const char OP_SUBSTITUTE_END[];
+
+/**
+ * @brief A command line and its tokens
+ * 
+ * Every buffer is kept from one line to the next, so once they have grown to fit the longest line seen,
+ * reading and tokenizing a line allocates nothing. Words are unquoted into the arena, each followed by a
+ * NUL, and the tokens are views of the arena or of the operator strings; no token is allocated on its own.
+ */
+struct command_line {
+    // The line as read, without its newline
+    std::string text;
+    // The words of the line, unquoted and NUL-terminated
+    std::string arena;
+    // One view per token, into the arena or at an operator
+    std::vector<std::string_view> tokens;
+    // The same tokens as a NULL-terminated argument array, for exec
+    std::vector<char *> args;
+    // Buffer for getline
+    char *read_buffer = NULL;
+    size_t read_capacity = 0;
+    
+    command_line() = default;
+    command_line(const command_line &) = delete;
+    command_line &operator=(const command_line &) = delete;
+    ~command_line();
+};
+
+/**
+ * @brief Read the next line, of any length, into line.text
+ * 
+ * @param line The command line to fill
+ * @param in The stream to read
+ * @return 1 if a line was read, 0 at end of input
+ */
+int read_command_line(command_line &line, FILE *in);
+
+/**
+ * @brief Split line.text into tokens, in one pass over it
+ * 
+ * Words are separated by spaces and tabs. The operators |, |>, <, >, >>, & and <( are tokens of their own,
+ * with or without spaces around them, and so is the ) that closes a <(; elsewhere ) is an ordinary
+ * character. Inside single quotes every character is literal; inside double quotes a
+ * backslash escapes only ", \, $ and `; elsewhere it escapes any character. Quoted parts next to each other
+ * and to unquoted text make up one word, and "" is an empty word.
+ * 
+ * @param line The command line; fills tokens and args
+ * @return Number of tokens, or -1 (after printing an error) if a quote or a <( is not closed
+ */
+int tokenize_command_line(command_line &line);